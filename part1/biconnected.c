@@ -0,0 +1,243 @@
+/*
+ The program will load the graph in main memory and compute its biconnected components (blocks), its articulation points and its bridges with the Hopcroft-Tarjan algorithm. The depth-first search is iterative, with an explicit stack, so that it works on deep graphs. The program expects an argument `edgelist.txt` that should contain the graph: one edge on each line (two unsigned long (nodes' ID) separated by a space); and an argument `results.txt` for writing the results: the articulation points, the bridges and the block ID of each edge (in the order of the edge list, "-" for self-loops).
+
+To compile:
+"gcc biconnected.c -O3 -o biconnected".
+
+To execute:
+"./biconnected graphs/edgelist.txt results/edgelist_biconnected.txt".
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+#include <time.h> // to estimate the runing time
+
+#define NLINKS 100000000 // maximum number of edges for memory allocation, will increase if needed
+#define NONE ULONG_MAX
+
+typedef struct {
+    unsigned long s;
+    unsigned long t;
+} edge;
+
+// edge list structure:
+typedef struct {
+    unsigned long n; // number of nodes
+    unsigned long e; // number of edges
+    edge *edges; // list of edges
+    unsigned long *cd; // cumulative degree cd[0]=0 length=n+1
+    unsigned long *adj; // concatenated lists of neighbors of all nodes
+    unsigned long *eid; // index in edges of each entry of adj
+} adjlist;
+
+// compute the maximum of three unsigned long
+inline unsigned long max3(unsigned long a,unsigned long b,unsigned long c){
+    a=(a>b) ? a : b;
+    return (a>c) ? a : c;
+}
+
+// reading the edgelist from file
+adjlist* readedgelist(char* input){
+    unsigned long e1=NLINKS;
+    FILE *file=fopen(input,"r");
+    adjlist *g=malloc(sizeof(adjlist));
+    g->n=0;
+    g->e=0;
+    g->edges=malloc(e1*sizeof(edge));//allocate some RAM to store edges
+    while (fscanf(file,"%lu %lu", &(g->edges[g->e].s), &(g->edges[g->e].t))==2) {
+        g->n=max3(g->n,g->edges[g->e].s,g->edges[g->e].t);
+        if (++(g->e)==e1) {//increase allocated RAM if needed
+            e1+=NLINKS;
+            g->edges=realloc(g->edges,e1*sizeof(edge));
+        }
+    }
+    fclose(file);
+    g->n++;
+    g->edges=realloc(g->edges,g->e*sizeof(edge));
+    return g;
+}
+
+// building the adjacency matrix, keeping the index of the edge of each entry
+void mkadjlist(adjlist* g){
+    unsigned long i,u,v;
+    unsigned long *d=calloc(g->n,sizeof(unsigned long));
+    for (i=0;i<g->e;i++) {
+        d[g->edges[i].s]++;
+        d[g->edges[i].t]++;
+    }
+    g->cd=malloc((g->n+1)*sizeof(unsigned long));
+    g->cd[0]=0;
+    for (i=1;i<g->n+1;i++) {
+        g->cd[i]=g->cd[i-1]+d[i-1];
+        d[i-1]=0;
+    }
+    g->adj=malloc(2*g->e*sizeof(unsigned long));
+    g->eid=malloc(2*g->e*sizeof(unsigned long));
+    for (i=0;i<g->e;i++) {
+        u=g->edges[i].s;
+        v=g->edges[i].t;
+        g->eid[ g->cd[u] + d[u] ]=i;
+        g->adj[ g->cd[u] + d[u]++ ]=v;
+        g->eid[ g->cd[v] + d[v] ]=i;
+        g->adj[ g->cd[v] + d[v]++ ]=u;
+    }
+    free(d);
+}
+
+// freeing memory
+void free_adjlist(adjlist *g){
+    free(g->edges);
+    free(g->cd);
+    free(g->adj);
+    free(g->eid);
+    free(g);
+}
+
+// computing the block of each edge, the articulation points and the bridges with an iterative depth-first search
+// returns the number of blocks
+unsigned long biconnected_components(adjlist *g, unsigned long *block, unsigned char *articulation, unsigned char *bridge){
+    unsigned long r, u, v, w, i, f, top = 0, top_edges = 0, time = 0, nb_blocks = 0, root_children;
+    // discovery time (0 if not visited) and low point of each node
+    unsigned long *disc = calloc(g->n, sizeof(unsigned long));
+    unsigned long *low = malloc(g->n*sizeof(unsigned long));
+    // next adjacency entry to explore and edge to the parent in the DFS tree of each node
+    unsigned long *next = malloc(g->n*sizeof(unsigned long));
+    unsigned long *parent_edge = malloc(g->n*sizeof(unsigned long));
+    // explicit DFS stack of nodes and stack of the edges of the current blocks
+    unsigned long *stack = malloc(g->n*sizeof(unsigned long));
+    unsigned long *stack_edges = malloc(g->e*sizeof(unsigned long));
+    for (i=0; i<g->e; i++){
+        block[i] = NONE;
+    }
+    for (r=0; r<g->n; r++){
+        if (disc[r] != 0 || g->cd[r+1] == g->cd[r])
+            continue;
+        // new DFS tree rooted at r
+        disc[r] = low[r] = ++time;
+        next[r] = g->cd[r];
+        parent_edge[r] = NONE;
+        stack[top++] = r;
+        root_children = 0;
+        while (top > 0){
+            v = stack[top-1];
+            if (next[v] < g->cd[v+1]){
+                // exploring the next edge of v
+                i = next[v]++;
+                w = g->adj[i];
+                f = g->eid[i];
+                if (f == parent_edge[v] || w == v) // edge to the parent or self-loop
+                    continue;
+                if (disc[w] == 0){ // tree edge
+                    stack_edges[top_edges++] = f;
+                    parent_edge[w] = f;
+                    disc[w] = low[w] = ++time;
+                    next[w] = g->cd[w];
+                    stack[top++] = w;
+                    if (v == r)
+                        root_children++;
+                }
+                else if (disc[w] < disc[v]){ // back edge to an ancestor
+                    stack_edges[top_edges++] = f;
+                    if (low[v] > disc[w])
+                        low[v] = disc[w];
+                }
+            }
+            else{
+                // v is finished: going back to its parent u
+                top--;
+                if (top == 0)
+                    break;
+                u = stack[top-1];
+                if (low[u] > low[v])
+                    low[u] = low[v];
+                if (low[v] >= disc[u]){
+                    // the edges above the tree edge u-v form a block, and u separates it from the rest (unless u is the root)
+                    if (u != r)
+                        articulation[u] = 1;
+                    do {
+                        f = stack_edges[--top_edges];
+                        block[f] = nb_blocks;
+                    } while (f != parent_edge[v]);
+                    nb_blocks++;
+                }
+                if (low[v] > disc[u])
+                    bridge[parent_edge[v]] = 1;
+            }
+        }
+        // the root is an articulation point if it has several children in the DFS tree
+        if (root_children > 1)
+            articulation[r] = 1;
+    }
+    free(disc);
+    free(low);
+    free(next);
+    free(parent_edge);
+    free(stack);
+    free(stack_edges);
+    return nb_blocks;
+}
+
+int main(int argc, char** argv){
+    // using the adjlist structure
+    adjlist* g;
+    time_t t1,t2;
+    if (argc < 3){
+        printf("Usage: %s edgelist.txt results.txt\n", argv[0]);
+        return 1;
+    }
+    t1=time(NULL);
+    printf("Reading edgelist from file %s\n",argv[1]);
+    g=readedgelist(argv[1]);
+    printf("Number of nodes: %lu\n",g->n);
+    printf("Number of edges: %lu\n",g->e);
+    printf("Building the adjacency list\n");
+    mkadjlist(g);
+    // initialisation
+    unsigned long i, nb_blocks, nb_articulations = 0, nb_bridges = 0;
+    unsigned long *block = malloc(g->e*sizeof(unsigned long));
+    unsigned char *articulation = calloc(g->n, sizeof(unsigned char));
+    unsigned char *bridge = calloc(g->e, sizeof(unsigned char));
+    // computing the biconnected components
+    nb_blocks = biconnected_components(g, block, articulation, bridge);
+    for (i=0; i<g->n; i++){
+        nb_articulations += articulation[i];
+    }
+    for (i=0; i<g->e; i++){
+        nb_bridges += bridge[i];
+    }
+    printf("Number of biconnected components: %lu\n", nb_blocks);
+    printf("Number of articulation points: %lu\n", nb_articulations);
+    printf("Number of bridges: %lu\n", nb_bridges);
+    // writing results in file
+    printf("Writing in file %s\n", argv[2]);
+    FILE *f = fopen(argv[2], "w");
+    fprintf(f, "Number of biconnected components: %lu\n", nb_blocks);
+    fprintf(f, "Number of articulation points: %lu\n", nb_articulations);
+    fprintf(f, "Number of bridges: %lu\n", nb_bridges);
+    fprintf(f, "\nArticulation points:\n");
+    for (i=0; i<g->n; i++){
+        if (articulation[i])
+            fprintf(f, "%lu\n", i);
+    }
+    fprintf(f, "\nBridges:\n");
+    for (i=0; i<g->e; i++){
+        if (bridge[i])
+            fprintf(f, "%lu %lu\n", g->edges[i].s, g->edges[i].t);
+    }
+    fprintf(f, "\nBlock of each edge:\n");
+    for (i=0; i<g->e; i++){
+        if (block[i] == NONE)
+            fprintf(f, "%lu %lu -\n", g->edges[i].s, g->edges[i].t);
+        else
+            fprintf(f, "%lu %lu %lu\n", g->edges[i].s, g->edges[i].t, block[i]);
+    }
+    fclose(f);
+    free(block);
+    free(articulation);
+    free(bridge);
+    free_adjlist(g);
+    t2=time(NULL);
+    printf("- Overall time = %ldh%ldm%lds\n",(t2-t1)/3600,((t2-t1)%3600)/60,((t2-t1)%60));
+    return 0;
+}
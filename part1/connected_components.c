@@ -1,24 +1,51 @@
 /*
- The program will load the graph in main memory and return the number of connected components as well as the fraction of nodes in the largest component. The program expects an argument `edgelist.txt` that should contain the graph: one edge on each line (two unsigned long (nodes' ID) separated by a space); and an argument `results.txt` for writing the results.
+ The program will load the graph in main memory and return the number of connected components as well as the fraction of nodes in the largest component. The program expects an argument `edgelist.txt` that should contain the graph: one edge on each line (two unsigned long (nodes' ID) separated by a space); and an argument `results.txt` for writing the results. The BFS are level-synchronous and run on all the threads (set OMP_NUM_THREADS to change their number).
+ With the optional argument `unionfind`, the components are computed instead with a parallel concurrent union-find (Afforest), the histogram of the component sizes is added to the results and the component ID of each node is written in the optional file `labels.txt`.
+ With the optional argument `stream`, the edges are read once from the file into a union-find with union by rank, without storing them nor building the adjacency list, so that the memory only depends on the number of nodes.
+ With the optional arguments `incremental state.bin`, the edges of the file are a batch of new edges applied to the union-find saved in `state.bin` (created if it does not exist), which is then updated; the histogram of the component sizes is added to the results.
  
 To compile:
-"gcc connected_components.c -O3 -o connected_components".
+"gcc connected_components.c -O3 -fopenmp -o connected_components".
 
 To execute:
 "./connected_components graphs/edgelist.txt results/edgelist_cc.txt".
+"./connected_components graphs/edgelist.txt results/edgelist_cc.txt unionfind results/edgelist_labels.txt".
+"./connected_components graphs/edgelist.txt results/edgelist_cc.txt stream".
+"./connected_components graphs/new_edges.txt results/edgelist_cc.txt incremental results/edgelist_cc_state.bin".
 */
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <time.h> // to estimate the runing time
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#define omp_get_thread_num() 0
+#define omp_get_num_threads() 1
+#endif
 
 #define NLINKS 100000000 // maximum number of edges for memory allocation, will increase if needed
+#define NEIGHBOR_ROUNDS 2 // number of neighbors of each node linked before sampling the largest component
+#define NB_SAMPLES 1024 // number of nodes sampled to find the largest component
 
 typedef struct {
     unsigned long s;
     unsigned long t;
 } edge;
 
+// union-find structure, grown while the edges are streamed
+typedef struct {
+    unsigned long n; // number of nodes
+    unsigned long allocated; // allocated number of nodes
+    unsigned long *parent; // parent of each node, roots are their own parent
+    unsigned char *rank; // upper bound on the height of the tree of each root
+    unsigned long *sizes; // size of the component of each root (only maintained if not NULL)
+    unsigned long nb_components; // number of components
+    unsigned long max_size; // size of the largest component (only maintained with sizes)
+} unionfind;
+
 // edge list structure:
 typedef struct {
     unsigned long n; // number of nodes
@@ -88,42 +115,71 @@ void free_adjlist(adjlist *g){
     free(g);
 }
 
-// BFS algorithm
-unsigned long bfs(adjlist *g, unsigned int *marker, unsigned long s){
-    // creating a FIFO to add and pop nodes easily
-    unsigned long *fifo = malloc(g->n * sizeof(unsigned long));
-    // initializing the number of nodes in the connected component to 0, the beginning and the end indexes of the FIFO to 0
-    unsigned long counter = 0, b = 0, e = 0;
-    // initializing index i for the for loop and two nodes u and v
-    unsigned long i, u, v;
-    // adding the source node to the FIFO and incrementing the end index of the FIFO
+// parallel level-synchronous BFS algorithm marking the nodes reachable from s and returning their number
+unsigned long bfs(adjlist *g, unsigned int *marker, unsigned long *fifo, unsigned long s){
+    // the FIFO stores the levels one after the other: the current level is fifo[b..e[ and the next one is written from e
+    unsigned long b = 0, e = 0;
+    int nb_threads = omp_get_max_threads();
+    // offsets[t+1] is the number of nodes of the next level found by thread t, then its writing offset after the prefix sum
+    // (the team may be smaller than nb_threads, so the prefix sum only runs over the threads of the team)
+    unsigned long *offsets = calloc(nb_threads + 1, sizeof(unsigned long));
+    // adding the source node to the FIFO and marking it
     fifo[e++] = s;
-    // marking the source node
     marker[s] = 1;
-    while (b != e) { // FIFO not empty
-        // popping the first node of the FIFO and incrementing the start index of the FIFO
-        u = fifo[b++];
-        // incrementing the number of nodes in the connected component
-        counter ++;
-        for (i = g->cd[u]; i < g->cd[u+1]; i++){ // Loop on u's neighbors
-            // v is a neighbor of u
-            v = g->adj[i];
-            if (marker[v] == 0) { // v not marked
-                // adding the node v to the FIFO and incrementing the end index of the FIFO
-                fifo[e++] = v;
-                // marking the node v
-                marker[v] = 1;
+    #pragma omp parallel num_threads(nb_threads)
+    {
+        int t = omp_get_thread_num(), nb_team = omp_get_num_threads(), k;
+        // thread-local buffer for the nodes of the next level
+        unsigned long size_buffer = 1024, nb_next, i, j, u, v;
+        unsigned long *buffer = malloc(size_buffer * sizeof(unsigned long));
+        while (b != e) { // current level not empty
+            nb_next = 0;
+            #pragma omp for schedule(dynamic, 64) nowait
+            for (i = b; i < e; i++){
+                u = fifo[i];
+                for (j = g->cd[u]; j < g->cd[u+1]; j++){ // Loop on u's neighbors
+                    v = g->adj[j];
+                    // marking v with an atomic compare-and-swap so that only one thread adds it to the next level
+                    if (marker[v] == 0 && __sync_bool_compare_and_swap(&marker[v], 0, 1)) {
+                        if (nb_next == size_buffer){ // increase the buffer if needed
+                            size_buffer *= 2;
+                            buffer = realloc(buffer, size_buffer * sizeof(unsigned long));
+                        }
+                        buffer[nb_next++] = v;
+                    }
+                }
+            }
+            offsets[t+1] = nb_next;
+            #pragma omp barrier
+            #pragma omp single
+            {
+                // prefix sum giving the position of each thread-local buffer in the next level
+                for (k = 1; k <= nb_team; k++){
+                    offsets[k] += offsets[k-1];
+                }
+            }
+            memcpy(fifo + e + offsets[t], buffer, nb_next * sizeof(unsigned long));
+            #pragma omp barrier
+            #pragma omp single
+            {
+                // the next level becomes the current level
+                b = e;
+                e += offsets[nb_team];
             }
         }
+        free(buffer);
     }
-    free(fifo);
-    return counter;
+    free(offsets);
+    // the FIFO contains all the nodes of the connected component
+    return e;
 }
 
 // computing the number of connected components as well as the fraction of nodes in the largest connected component
 void number_connected_components(adjlist *g, char *output){
     // to mark a node once it is visited
     unsigned int *marker = calloc(g->n, sizeof(unsigned long));
+    // FIFO shared by all the BFS
+    unsigned long *fifo = malloc(g->n * sizeof(unsigned long));
     // initialisation of the number of connected components and of the size of the largest connected component
     unsigned long number_connected_components = 0, max_size_component = 0;
     // initialisation of the source node and of the size of each component
@@ -133,7 +189,13 @@ void number_connected_components(adjlist *g, char *output){
             // incrementing the number of connected components
             number_connected_components++;
             // using BFS to compute the size of the connected component containing the node s
-            size_component = bfs(g, marker, s);
+            if (g->cd[s+1] == g->cd[s]){ // isolated node
+                marker[s] = 1;
+                size_component = 1;
+            }
+            else{
+                size_component = bfs(g, marker, fifo, s);
+            }
             // setting the size of the largest connected component to the current size it the latter is larger that the former
             if (max_size_component < size_component){
                 max_size_component = size_component;
@@ -152,6 +214,308 @@ void number_connected_components(adjlist *g, char *output){
     fprintf(f,"Fraction of nodes in the largest connected component: %lu/%lu = %f\n", max_size_component, g->n, fraction_main_component);
     fclose(f);
     free(marker);
+    free(fifo);
+}
+
+// linking the trees of u and v: the larger root is hooked below the smaller one with a compare-and-swap
+void link_nodes(unsigned long *comp, unsigned long u, unsigned long v){
+    unsigned long p1 = comp[u], p2 = comp[v], high, low, p_high;
+    while (p1 != p2){
+        high = (p1 > p2) ? p1 : p2;
+        low = p1 + p2 - high;
+        p_high = comp[high];
+        // already linked
+        if (p_high == low)
+            break;
+        // high is a root: trying to hook it below low
+        if (p_high == high && __sync_bool_compare_and_swap(&comp[high], high, low))
+            break;
+        // another thread changed the trees: climbing and retrying
+        p1 = comp[comp[high]];
+        p2 = comp[low];
+    }
+}
+
+// compressing the paths so that each node points directly to its root
+void compress(unsigned long n, unsigned long *comp){
+    unsigned long u;
+    #pragma omp parallel for schedule(dynamic, 16384)
+    for (u = 0; u < n; u++){
+        while (comp[u] != comp[comp[u]]){
+            comp[u] = comp[comp[u]];
+        }
+    }
+}
+
+// finding the most frequent component among NB_SAMPLES random nodes
+unsigned long sample_frequent_component(unsigned long n, unsigned long *comp){
+    unsigned long i, j, nb_distinct = 0, best = 0;
+    unsigned long samples[NB_SAMPLES], counts[NB_SAMPLES];
+    srand(time(NULL));
+    for (i = 0; i < NB_SAMPLES; i++){
+        samples[i] = comp[(unsigned long)rand() % n];
+        for (j = 0; j < nb_distinct && samples[j] != samples[i]; j++);
+        if (j == nb_distinct){
+            samples[nb_distinct] = samples[i];
+            counts[nb_distinct++] = 0;
+        }
+        counts[j]++;
+        if (counts[j] > counts[best])
+            best = j;
+    }
+    return samples[best];
+}
+
+// computing the component of each node with the Afforest algorithm (Sutton, Ben-Nun and Barak)
+void afforest(adjlist *g, unsigned long *comp){
+    unsigned long u, r, c;
+    #pragma omp parallel for
+    for (u = 0; u < g->n; u++){
+        comp[u] = u;
+    }
+    // linking each node to its first neighbors only
+    for (r = 0; r < NEIGHBOR_ROUNDS; r++){
+        #pragma omp parallel for schedule(dynamic, 16384)
+        for (u = 0; u < g->n; u++){
+            if (g->cd[u] + r < g->cd[u+1])
+                link_nodes(comp, u, g->adj[g->cd[u] + r]);
+        }
+        compress(g->n, comp);
+    }
+    // the nodes of the largest component found so far are skipped: their remaining edges are linked from the other side
+    c = sample_frequent_component(g->n, comp);
+    #pragma omp parallel for schedule(dynamic, 16384)
+    for (u = 0; u < g->n; u++){
+        unsigned long i;
+        if (comp[u] == c)
+            continue;
+        for (i = g->cd[u] + NEIGHBOR_ROUNDS; i < g->cd[u+1]; i++){
+            link_nodes(comp, u, g->adj[i]);
+        }
+    }
+    compress(g->n, comp);
+}
+
+// comparing 2 component sizes
+static int compare_sizes(void const *e1, void const *e2){
+    unsigned long const *size1 = e1;
+    unsigned long const *size2 = e2;
+    return (*size1 > *size2) - (*size1 < *size2);
+}
+
+// writing the number of components, the fraction of nodes in the largest one and, if sizes is not NULL, the histogram of the sizes (sorted by the function)
+void write_results(unsigned long n, unsigned long number_connected_components, unsigned long max_size_component, unsigned long *sizes, char *output){
+    unsigned long i, j;
+    // computing the fraction of nodes in the largest connected component
+    float fraction_main_component = (float)max_size_component/((float)n);
+    // displaying results
+    printf("Number of connected components: %lu\n", number_connected_components);
+    printf("Fraction of nodes in the largest connected component: %lu/%lu = %f\n", max_size_component, n, fraction_main_component);
+    // writing results in file
+    printf("Writing in file %s\n", output);
+    FILE *f = fopen(output, "w");
+    fprintf(f,"Number of connected components: %lu\n", number_connected_components);
+    fprintf(f,"Fraction of nodes in the largest connected component: %lu/%lu = %f\n", max_size_component, n, fraction_main_component);
+    if (sizes != NULL){
+        qsort(sizes, number_connected_components, sizeof(unsigned long), compare_sizes);
+        fprintf(f,"\nComponent sizes (size, number of components):\n");
+        for (i = 0; i < number_connected_components; i = j){
+            for (j = i; j < number_connected_components && sizes[j] == sizes[i]; j++);
+            fprintf(f,"%lu %lu\n", sizes[i], j-i);
+        }
+    }
+    fclose(f);
+}
+
+// writing the component of each node
+void write_labels(unsigned long n, unsigned long *comp, char *labels){
+    unsigned long u;
+    printf("Writing in file %s\n", labels);
+    FILE *f = fopen(labels, "w");
+    for (u = 0; u < n; u++){
+        fprintf(f,"%lu %lu\n", u, comp[u]);
+    }
+    fclose(f);
+}
+
+// writing the results given the root of the component of each node, with the histogram of the sizes if histogram is not 0
+void write_components(unsigned long n, unsigned long *comp, char *output, char *labels, int histogram){
+    unsigned long u, number_connected_components = 0, max_size_component = 0;
+    unsigned long *sizes = calloc(n, sizeof(unsigned long));
+    // size of each component, stored at its root
+    #pragma omp parallel for
+    for (u = 0; u < n; u++){
+        __sync_fetch_and_add(&sizes[comp[u]], 1);
+    }
+    // gathering the sizes of the components, node 0 being counted only if it is linked to another node as in number_connected_components
+    for (u = 0; u < n; u++){
+        if (comp[u] == u && (u > 0 || sizes[u] > 1)){
+            sizes[number_connected_components++] = sizes[u];
+            if (max_size_component < sizes[u])
+                max_size_component = sizes[u];
+        }
+    }
+    write_results(n, number_connected_components, max_size_component, histogram ? sizes : NULL, output);
+    if (labels != NULL)
+        write_labels(n, comp, labels);
+    free(sizes);
+}
+
+// adding the nodes up to u to the union-find structure, each one in its own component
+void uf_grow(unionfind *uf, unsigned long u){
+    unsigned long i;
+    if (u < uf->n)
+        return;
+    if (u >= uf->allocated){ // increase allocated RAM if needed
+        uf->allocated = (2*uf->allocated > u+1) ? 2*uf->allocated : u+1;
+        uf->parent = realloc(uf->parent, uf->allocated*sizeof(unsigned long));
+        uf->rank = realloc(uf->rank, uf->allocated*sizeof(unsigned char));
+        if (uf->sizes != NULL)
+            uf->sizes = realloc(uf->sizes, uf->allocated*sizeof(unsigned long));
+    }
+    for (i = uf->n; i <= u; i++){
+        uf->parent[i] = i;
+        uf->rank[i] = 0;
+        if (uf->sizes != NULL)
+            uf->sizes[i] = 1;
+    }
+    if (uf->sizes != NULL && uf->max_size == 0)
+        uf->max_size = 1;
+    uf->nb_components += u+1 - uf->n;
+    uf->n = u+1;
+}
+
+// finding the root of u, halving the path on the way
+unsigned long uf_find(unionfind *uf, unsigned long u){
+    while (uf->parent[u] != u){
+        uf->parent[u] = uf->parent[uf->parent[u]];
+        u = uf->parent[u];
+    }
+    return u;
+}
+
+// merging the components of u and v (union by rank), returning 1 if they were different
+int uf_union(unionfind *uf, unsigned long u, unsigned long v){
+    unsigned long tmp;
+    u = uf_find(uf, u);
+    v = uf_find(uf, v);
+    if (u == v)
+        return 0;
+    // v becomes a child of u
+    if (uf->rank[u] < uf->rank[v]){
+        tmp = u;
+        u = v;
+        v = tmp;
+    }
+    uf->parent[v] = u;
+    if (uf->rank[u] == uf->rank[v])
+        uf->rank[u]++;
+    if (uf->sizes != NULL){
+        uf->sizes[u] += uf->sizes[v];
+        if (uf->max_size < uf->sizes[u])
+            uf->max_size = uf->sizes[u];
+    }
+    uf->nb_components--;
+    return 1;
+}
+
+// computing the connected components while reading the edges once from the file
+void stream_components(char *input, char *output, char *labels){
+    unsigned long u, v, e = 0;
+    unionfind uf = {0, 0, NULL, NULL, NULL, 0, 0};
+    FILE *file = fopen(input, "r");
+    while (fscanf(file, "%lu %lu", &u, &v) == 2){
+        uf_grow(&uf, max3(u, v, 0));
+        uf_union(&uf, u, v);
+        e++;
+    }
+    fclose(file);
+    printf("Number of nodes: %lu\n", uf.n);
+    printf("Number of edges: %lu\n", e);
+    // each node points directly to its root
+    for (u = 0; u < uf.n; u++){
+        uf.parent[u] = uf_find(&uf, u);
+    }
+    free(uf.rank);
+    write_components(uf.n, uf.parent, output, labels, 0);
+    free(uf.parent);
+}
+
+// loading the union-find structure from a state file, returns 0 if the file does not exist
+int load_state(unionfind *uf, char *input){
+    FILE *file = fopen(input, "rb");
+    if (file == NULL)
+        return 0;
+    if (fread(&(uf->n), sizeof(unsigned long), 1, file) != 1 || fread(&(uf->nb_components), sizeof(unsigned long), 1, file) != 1 || fread(&(uf->max_size), sizeof(unsigned long), 1, file) != 1){
+        printf("Invalid state file %s\n", input);
+        exit(1);
+    }
+    uf->allocated = uf->n;
+    uf->parent = malloc(uf->n*sizeof(unsigned long));
+    uf->rank = malloc(uf->n*sizeof(unsigned char));
+    uf->sizes = malloc(uf->n*sizeof(unsigned long));
+    if (fread(uf->parent, sizeof(unsigned long), uf->n, file) != uf->n || fread(uf->rank, sizeof(unsigned char), uf->n, file) != uf->n || fread(uf->sizes, sizeof(unsigned long), uf->n, file) != uf->n){
+        printf("Invalid state file %s\n", input);
+        exit(1);
+    }
+    fclose(file);
+    return 1;
+}
+
+// saving the union-find structure in a state file
+void save_state(unionfind *uf, char *output){
+    FILE *file = fopen(output, "wb");
+    fwrite(&(uf->n), sizeof(unsigned long), 1, file);
+    fwrite(&(uf->nb_components), sizeof(unsigned long), 1, file);
+    fwrite(&(uf->max_size), sizeof(unsigned long), 1, file);
+    fwrite(uf->parent, sizeof(unsigned long), uf->n, file);
+    fwrite(uf->rank, sizeof(unsigned char), uf->n, file);
+    fwrite(uf->sizes, sizeof(unsigned long), uf->n, file);
+    fclose(file);
+}
+
+// applying a batch of new edges to the connected components saved in the state file
+void incremental_components(char *input, char *output, char *state, char *labels){
+    unsigned long u, v, e = 0, merges = 0, nb_components = 0;
+    unionfind uf = {0, 0, NULL, NULL, NULL, 0, 0};
+    if (load_state(&uf, state)){
+        printf("Loading state from file %s: %lu nodes, %lu connected components\n", state, uf.n, uf.nb_components);
+    }
+    else{
+        printf("No state file %s: starting from an empty graph\n", state);
+        uf.sizes = malloc(sizeof(unsigned long));
+    }
+    // applying the batch
+    FILE *file = fopen(input, "r");
+    while (fscanf(file, "%lu %lu", &u, &v) == 2){
+        uf_grow(&uf, max3(u, v, 0));
+        merges += uf_union(&uf, u, v);
+        e++;
+    }
+    fclose(file);
+    printf("Batch of %lu edges: %lu merges\n", e, merges);
+    printf("Number of nodes: %lu\n", uf.n);
+    // gathering the sizes of the components from their roots, node 0 being counted only if it is linked to another node as in number_connected_components
+    unsigned long *sizes = malloc(uf.nb_components*sizeof(unsigned long));
+    for (u = 0; u < uf.n; u++){
+        if (uf.parent[u] == u && (u > 0 || uf.sizes[u] > 1))
+            sizes[nb_components++] = uf.sizes[u];
+    }
+    write_results(uf.n, nb_components, uf.max_size, sizes, output);
+    free(sizes);
+    if (labels != NULL){
+        unsigned long *comp = malloc(uf.n*sizeof(unsigned long));
+        for (u = 0; u < uf.n; u++){
+            comp[u] = uf_find(&uf, u);
+        }
+        write_labels(uf.n, comp, labels);
+        free(comp);
+    }
+    printf("Saving state in file %s\n", state);
+    save_state(&uf, state);
+    free(uf.parent);
+    free(uf.rank);
+    free(uf.sizes);
 }
 
 int main(int argc, char** argv){
@@ -159,14 +523,40 @@ int main(int argc, char** argv){
     adjlist* g;
     time_t t1,t2;
     t1=time(NULL);
+    if (argc > 3 && strcmp(argv[3], "stream") == 0){
+        // computing the connected components without storing the graph
+        printf("Streaming edgelist from file %s\n",argv[1]);
+        stream_components(argv[1], argv[2], (argc > 4) ? argv[4] : NULL);
+        t2=time(NULL);
+        printf("- Overall time = %ldh%ldm%lds\n",(t2-t1)/3600,((t2-t1)%3600)/60,((t2-t1)%60));
+        return 0;
+    }
+    if (argc > 4 && strcmp(argv[3], "incremental") == 0){
+        // updating the connected components with a batch of new edges
+        printf("Reading batch of edges from file %s\n",argv[1]);
+        incremental_components(argv[1], argv[2], argv[4], (argc > 5) ? argv[5] : NULL);
+        t2=time(NULL);
+        printf("- Overall time = %ldh%ldm%lds\n",(t2-t1)/3600,((t2-t1)%3600)/60,((t2-t1)%60));
+        return 0;
+    }
     printf("Reading edgelist from file %s\n",argv[1]);
     g=readedgelist(argv[1]);
     printf("Number of nodes: %lu\n",g->n);
     printf("Number of edges: %lu\n",g->e);
     printf("Building the adjacency list\n");
     mkadjlist(g);
-    // computing the number of connected components as well as the fraction of nodes in the largest connected component
-    number_connected_components(g, argv[2]);
+    if (argc > 3 && strcmp(argv[3], "unionfind") == 0){
+        // computing the component of each node with a parallel union-find
+        unsigned long *comp = malloc(g->n * sizeof(unsigned long));
+        printf("Afforest algorithm\n");
+        afforest(g, comp);
+        write_components(g->n, comp, argv[2], (argc > 4) ? argv[4] : NULL, 1);
+        free(comp);
+    }
+    else{
+        // computing the number of connected components as well as the fraction of nodes in the largest connected component
+        number_connected_components(g, argv[2]);
+    }
     free_adjlist(g);
     t2=time(NULL);
     printf("- Overall time = %ldh%ldm%lds\n",(t2-t1)/3600,((t2-t1)%3600)/60,((t2-t1)%60));
@@ -1,16 +1,26 @@
 /*
- The program will load the graph in main memory and compute a good lower bound to the diameter of a graph. The program expects an argument `edgelist.txt` that should contain the graph: one edge on each line (two unsigned long (nodes' ID) separated by a space); and an argument `results.txt` for writing the results.
+ The program will load the graph in main memory and compute a good lower bound to the diameter of a graph. The program expects an argument `edgelist.txt` that should contain the graph: one edge on each line (two unsigned long (nodes' ID) separated by a space); and an argument `results.txt` for writing the results. With the optional argument `exact`, the program computes instead the exact diameter and radius of the largest connected component using the BoundingDiameters algorithm. The BFS are level-synchronous and run on all the threads (set OMP_NUM_THREADS to change their number).
  
 To compile:
-"gcc diameter.c -O3 -o diameter".
+"gcc diameter.c -O3 -fopenmp -o diameter".
 
 To execute:
 "./diameter graphs/edgelist.txt results/tuto_diameter.txt".
+"./diameter graphs/edgelist.txt results/tuto_diameter_exact.txt exact".
 */
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
 #include <time.h> // to estimate the runing time
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#define omp_get_thread_num() 0
+#define omp_get_num_threads() 1
+#endif
 
 #define NLINKS 100000000 // maximum number of edges for memory allocation, will increase if needed
 #define NITER 20
@@ -89,47 +99,84 @@ void free_adjlist(adjlist *g){
     free(g);
 }
 
-// BFS algorithm
-unsigned long bfs(adjlist *g, unsigned long s, unsigned long *diameter){
-    // creating a FIFO to add and pop nodes easily
-    unsigned long *fifo = malloc(g->n * sizeof(unsigned long));
-    // to mark a node once it is visited
-    unsigned int *marker = calloc(g->n, sizeof(unsigned long));
-    // creating a array to store node distance from the source node
-    unsigned long *distances = calloc(g->n, sizeof(unsigned long));
-    // initializing the beginning and the end indexes of the FIFO to 0, and the farthest node from s to s
-    unsigned long b = 0, e = 0, w = s;
-    // initializing index i for the for loop and two nodes u and v
-    unsigned long i, u, v;
-    // adding the source node to the FIFO and incrementing the end index of the FIFO
+// parallel level-synchronous BFS algorithm storing the distance from s to each reached node (unreached nodes keep the distance ULONG_MAX) and returning the eccentricity of s
+unsigned long bfs_distances(adjlist *g, unsigned long s, unsigned long *fifo, unsigned long *distances, unsigned long *reached){
+    // the FIFO stores the levels one after the other: the current level is fifo[b..e[ and the next one is written from e
+    unsigned long b = 0, e = 0, level = 0;
+    int nb_threads = omp_get_max_threads();
+    // offsets[t+1] is the number of nodes of the next level found by thread t, then its writing offset after the prefix sum
+    // (the team may be smaller than nb_threads, so the prefix sum only runs over the threads of the team)
+    unsigned long *offsets = calloc(nb_threads + 1, sizeof(unsigned long));
+    // adding the source node to the FIFO
     fifo[e++] = s;
-    // marking the source node
-    marker[s] = 1;
-    while (b != e) { // FIFO not empty
-        // popping the first node of the FIFO and incrementing the start index of the FIFO
-        u = fifo[b++];
-        for (i = g->cd[u]; i < g->cd[u+1]; i++){ // Loop on u's neighbors
-            // v is a neighbor of u
-            v = g->adj[i];
-            if (marker[v] == 0) { // v not marked
-                // adding the node v to the FIFO and incrementing the end index of the FIFO
-                fifo[e++] = v;
-                // marking the node v
-                marker[v] = 1;
-                // updating the distance from v to s
-                distances[v] = distances[u] + 1;
-                // updating the max distance from s and the farthest node
-                if (*diameter < distances[v]){
-                    *diameter = distances[v];
-                    w = v;
+    distances[s] = 0;
+    #pragma omp parallel num_threads(nb_threads)
+    {
+        int t = omp_get_thread_num(), nb_team = omp_get_num_threads(), k;
+        // thread-local buffer for the nodes of the next level
+        unsigned long size_buffer = 1024, nb_next, i, j, u, v;
+        unsigned long *buffer = malloc(size_buffer * sizeof(unsigned long));
+        while (b != e) { // current level not empty
+            nb_next = 0;
+            #pragma omp for schedule(dynamic, 64) nowait
+            for (i = b; i < e; i++){
+                u = fifo[i];
+                for (j = g->cd[u]; j < g->cd[u+1]; j++){ // Loop on u's neighbors
+                    v = g->adj[j];
+                    // claiming v with an atomic compare-and-swap so that only one thread adds it to the next level
+                    if (distances[v] == ULONG_MAX && __sync_bool_compare_and_swap(&distances[v], ULONG_MAX, level + 1)) {
+                        if (nb_next == size_buffer){ // increase the buffer if needed
+                            size_buffer *= 2;
+                            buffer = realloc(buffer, size_buffer * sizeof(unsigned long));
+                        }
+                        buffer[nb_next++] = v;
+                    }
+                }
+            }
+            offsets[t+1] = nb_next;
+            #pragma omp barrier
+            #pragma omp single
+            {
+                // prefix sum giving the position of each thread-local buffer in the next level
+                for (k = 1; k <= nb_team; k++){
+                    offsets[k] += offsets[k-1];
                 }
             }
+            memcpy(fifo + e + offsets[t], buffer, nb_next * sizeof(unsigned long));
+            #pragma omp barrier
+            #pragma omp single
+            {
+                // the next level becomes the current level
+                b = e;
+                e += offsets[nb_team];
+                level++;
+            }
         }
+        free(buffer);
     }
+    free(offsets);
+    // the FIFO contains the reached nodes, the last one being the farthest from s
+    *reached = e;
+    return distances[fifo[e-1]];
+}
+
+// BFS algorithm returning the farthest node from s
+unsigned long bfs(adjlist *g, unsigned long s, unsigned long *diameter){
+    // creating a FIFO storing the nodes level by level
+    unsigned long *fifo = malloc(g->n * sizeof(unsigned long));
+    // creating a array to store node distance from the source node
+    unsigned long *distances = malloc(g->n * sizeof(unsigned long));
+    unsigned long i, reached;
+    #pragma omp parallel for
+    for (i = 0; i < g->n; i++){
+        distances[i] = ULONG_MAX;
+    }
+    // the max distance from s and the farthest node are the last ones of the FIFO
+    *diameter = bfs_distances(g, s, fifo, distances, &reached);
+    s = fifo[reached-1];
     free(fifo);
-    free(marker);
     free(distances);
-    return w;
+    return s;
 }
 
 // computing a good lower bound to the diameter of a graph
@@ -161,6 +208,119 @@ unsigned long lower_bound_diameter(adjlist *g, unsigned long seed){
     return diameter;
 }
 
+// computing the exact diameter and radius of the largest connected component with the BoundingDiameters algorithm (Takes and Kosters)
+unsigned long exact_diameter(adjlist *g, unsigned long *radius, unsigned long *nb_bfs){
+    // initializing indexes, nodes, the eccentricity of the BFS source and the number of reached nodes
+    unsigned long i, j, s, v, w, d, ecc, reached;
+    // initializing the size of the largest connected component, a node inside it and the number of candidate nodes
+    unsigned long size_lcc = 0, seed = 0, nb_candidates;
+    // bounds on the diameter and on the radius
+    unsigned long diameter_lower = 0, diameter_upper = ULONG_MAX, radius_lower = 0, radius_upper = ULONG_MAX;
+    // FIFO and distances shared by all the BFS
+    unsigned long *fifo = malloc(g->n * sizeof(unsigned long));
+    unsigned long *distances = malloc(g->n * sizeof(unsigned long));
+    // lower and upper bounds to the eccentricity of each node
+    unsigned long *ecc_lower = calloc(g->n, sizeof(unsigned long));
+    unsigned long *ecc_upper = malloc(g->n * sizeof(unsigned long));
+    // nodes whose eccentricity bounds may still change the diameter or the radius
+    unsigned long *candidates = malloc(g->n * sizeof(unsigned long));
+    #pragma omp parallel for
+    for (v = 0; v < g->n; v++){
+        distances[v] = ULONG_MAX;
+    }
+    // finding the largest connected component
+    for (s = 0; s < g->n; s++){
+        if (distances[s] == ULONG_MAX){
+            bfs_distances(g, s, fifo, distances, &reached);
+            if (reached > size_lcc){
+                size_lcc = reached;
+                seed = s;
+            }
+        }
+    }
+    #pragma omp parallel for
+    for (v = 0; v < g->n; v++){
+        distances[v] = ULONG_MAX;
+    }
+    // every node of the largest connected component is a candidate
+    bfs_distances(g, seed, fifo, distances, &nb_candidates);
+    for (i = 0; i < nb_candidates; i++){
+        candidates[i] = fifo[i];
+        ecc_upper[fifo[i]] = ULONG_MAX;
+        distances[fifo[i]] = ULONG_MAX;
+    }
+    *nb_bfs = 0;
+    while ((diameter_lower != diameter_upper || radius_lower != radius_upper) && nb_candidates > 0){
+        // selecting alternately the candidate with the largest upper bound and the one with the smallest lower bound, ties broken by the largest degree
+        // (only the first kind once the radius is known, only the second one once the diameter is known)
+        j = 0;
+        for (i = 1; i < nb_candidates; i++){
+            v = candidates[i];
+            w = candidates[j];
+            if ((*nb_bfs % 2 == 0 && diameter_lower != diameter_upper) || radius_lower == radius_upper){
+                if (ecc_upper[v] > ecc_upper[w] || (ecc_upper[v] == ecc_upper[w] && g->cd[v+1]-g->cd[v] > g->cd[w+1]-g->cd[w]))
+                    j = i;
+            }
+            else{
+                if (ecc_lower[v] < ecc_lower[w] || (ecc_lower[v] == ecc_lower[w] && g->cd[v+1]-g->cd[v] > g->cd[w+1]-g->cd[w]))
+                    j = i;
+            }
+        }
+        s = candidates[j];
+        candidates[j] = candidates[--nb_candidates];
+        // computing the eccentricity of s
+        ecc = bfs_distances(g, s, fifo, distances, &reached);
+        (*nb_bfs)++;
+        ecc_lower[s] = ecc;
+        ecc_upper[s] = ecc;
+        if (diameter_lower < ecc)
+            diameter_lower = ecc;
+        if (radius_upper > ecc)
+            radius_upper = ecc;
+        // updating the eccentricity bounds of the candidates with the triangle inequality
+        for (i = 0; i < nb_candidates; i++){
+            w = candidates[i];
+            d = distances[w];
+            ecc_lower[w] = max3(ecc_lower[w], d, ecc - d);
+            if (ecc_upper[w] > ecc + d)
+                ecc_upper[w] = ecc + d;
+            if (diameter_lower < ecc_lower[w])
+                diameter_lower = ecc_lower[w];
+            if (radius_upper > ecc_upper[w])
+                radius_upper = ecc_upper[w];
+        }
+        // pruning the candidates that can neither increase the diameter nor decrease the radius
+        diameter_upper = diameter_lower;
+        radius_lower = radius_upper;
+        for (i = 0; i < nb_candidates; ){
+            w = candidates[i];
+            if (ecc_upper[w] <= diameter_lower && ecc_lower[w] >= radius_upper){
+                candidates[i] = candidates[--nb_candidates];
+            }
+            else{
+                if (diameter_upper < ecc_upper[w])
+                    diameter_upper = ecc_upper[w];
+                if (radius_lower > ecc_lower[w])
+                    radius_lower = ecc_lower[w];
+                i++;
+            }
+        }
+        // resetting the distances of the reached nodes
+        for (i = 0; i < reached; i++){
+            distances[fifo[i]] = ULONG_MAX;
+        }
+        printf("    -- BFS %lu from node %lu: eccentricity %lu, diameter in [%lu, %lu], radius in [%lu, %lu], %lu candidates left\n", *nb_bfs, s, ecc, diameter_lower, diameter_upper, radius_lower, radius_upper, nb_candidates);
+    }
+    printf("    Size of the largest connected component: %lu\n", size_lcc);
+    free(fifo);
+    free(distances);
+    free(ecc_lower);
+    free(ecc_upper);
+    free(candidates);
+    *radius = radius_upper;
+    return diameter_lower;
+}
+
 int main(int argc, char** argv){
     // using the adjlist structure
     adjlist* g;
@@ -172,6 +332,25 @@ int main(int argc, char** argv){
     printf("Number of edges: %lu\n",g->e);
     printf("Building the adjacency list\n");
     mkadjlist(g);
+    if (argc > 3 && strcmp(argv[3], "exact") == 0){
+        // computing the exact diameter and radius of the largest connected component
+        unsigned long radius, nb_bfs;
+        printf("BoundingDiameters algorithm:\n");
+        unsigned long diameter = exact_diameter(g, &radius, &nb_bfs);
+        printf("Diameter of the largest connected component: %lu\n", diameter);
+        printf("Radius of the largest connected component: %lu\n", radius);
+        printf("Number of BFS: %lu\n", nb_bfs);
+        // writing resuls
+        FILE *f = fopen(argv[2], "w");
+        fprintf(f, "Diameter of the largest connected component: %lu\n", diameter);
+        fprintf(f, "Radius of the largest connected component: %lu\n", radius);
+        fprintf(f, "Number of BFS: %lu\n", nb_bfs);
+        fclose(f);
+        free_adjlist(g);
+        t2=time(NULL);
+        printf("- Overall time = %ldh%ldm%lds\n",(t2-t1)/3600,((t2-t1)%3600)/60,((t2-t1)%60));
+        return 0;
+    }
     // computing a good lower bound to the diameter of a graph
     printf("Diameter algorithm:\n");
     printf("    First pass:\n");
@@ -0,0 +1,269 @@
+/*
+ The program will load the graph in main memory and estimate its neighbourhood function with the HyperANF algorithm (Boldi, Rosa and Vigna): each node holds a HyperLogLog counter of the nodes at distance at most t from it, and at each iteration the counter of a node becomes the register-wise maximum of its own counter and of the counters of its neighbors. The program derives the distance distribution, the average distance and the effective diameter (90th percentile of the distances) of the graph. The program expects an argument `edgelist.txt` that should contain the graph: one edge on each line (two unsigned long (nodes' ID) separated by a space); an argument `results.txt` for writing the results; and optionally the memory budget per node in bytes (128 by default), shared by the two counters of each node.
+
+To compile:
+"gcc hyperanf.c -O3 -fopenmp -lm -o hyperanf".
+
+To execute:
+"./hyperanf graphs/edgelist.txt results/edgelist_hyperanf.txt 128".
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h> // to estimate the runing time
+
+#define NLINKS 100000000 // maximum number of edges for memory allocation, will increase if needed
+#define NB_DEFAULT_BYTES 128 // default memory budget per node (in bytes)
+#define MIN_LOG_REGISTERS 4 // at least 16 registers per counter
+#define MAX_ITERATIONS 10000
+#define PERCENTILE 0.9 // for the effective diameter
+#define HIGH_BITS 0x8080808080808080ULL // high bit of each byte of a word
+#define LOW_BITS 0x0101010101010101ULL // low bit of each byte of a word
+
+typedef struct {
+    unsigned long s;
+    unsigned long t;
+} edge;
+
+// edge list structure:
+typedef struct {
+    unsigned long n; // number of nodes
+    unsigned long e; // number of edges
+    edge *edges; // list of edges
+    unsigned long *cd; // cumulative degree cd[0]=0 length=n+1
+    unsigned long *adj; // concatenated lists of neighbors of all nodes
+} adjlist;
+
+// compute the maximum of three unsigned long
+inline unsigned long max3(unsigned long a,unsigned long b,unsigned long c){
+    a=(a>b) ? a : b;
+    return (a>c) ? a : c;
+}
+
+// reading the edgelist from file
+adjlist* readedgelist(char* input){
+    unsigned long e1=NLINKS;
+    FILE *file=fopen(input,"r");
+    adjlist *g=malloc(sizeof(adjlist));
+    g->n=0;
+    g->e=0;
+    g->edges=malloc(e1*sizeof(edge));//allocate some RAM to store edges
+    while (fscanf(file,"%lu %lu", &(g->edges[g->e].s), &(g->edges[g->e].t))==2) {
+        g->n=max3(g->n,g->edges[g->e].s,g->edges[g->e].t);
+        if (++(g->e)==e1) {//increase allocated RAM if needed
+            e1+=NLINKS;
+            g->edges=realloc(g->edges,e1*sizeof(edge));
+        }
+    }
+    fclose(file);
+    g->n++;
+    g->edges=realloc(g->edges,g->e*sizeof(edge));
+    return g;
+}
+
+// building the adjacency matrix
+void mkadjlist(adjlist* g){
+    unsigned long i,u,v;
+    unsigned long *d=calloc(g->n,sizeof(unsigned long));
+    for (i=0;i<g->e;i++) {
+        d[g->edges[i].s]++;
+        d[g->edges[i].t]++;
+    }
+    g->cd=malloc((g->n+1)*sizeof(unsigned long));
+    g->cd[0]=0;
+    for (i=1;i<g->n+1;i++) {
+        g->cd[i]=g->cd[i-1]+d[i-1];
+        d[i-1]=0;
+    }
+    g->adj=malloc(2*g->e*sizeof(unsigned long));
+    for (i=0;i<g->e;i++) {
+        u=g->edges[i].s;
+        v=g->edges[i].t;
+        g->adj[ g->cd[u] + d[u]++ ]=v;
+        g->adj[ g->cd[v] + d[v]++ ]=u;
+    }
+    free(d);
+    // free(g->edges);
+}
+
+// freeing memory
+void free_adjlist(adjlist *g){
+    free(g->edges);
+    free(g->cd);
+    free(g->adj);
+    free(g);
+}
+
+
+// wall-clock time in seconds
+double wall_time(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+// hashing a node ID (finalizer of splitmix64)
+uint64_t hash_node(uint64_t x){
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// byte-wise maximum of two words, each byte being a register smaller than 128
+static inline uint64_t broadword_max(uint64_t x, uint64_t y){
+    // the high bit of a byte of ((x|H)-y)&H is set iff the register of x is not smaller than the register of y
+    uint64_t ge = ((x | HIGH_BITS) - y) & HIGH_BITS;
+    // spreading this bit over the whole byte
+    uint64_t mask = (ge >> 7) * 0xFF;
+    return (x & mask) | (y & ~mask);
+}
+
+// HyperLogLog estimate of the number of elements of a counter with m = 2^b registers
+double hll_estimate(unsigned char *counter, unsigned long m){
+    unsigned long j, zeros = 0;
+    double sum = 0., estimate, alpha;
+    for (j=0; j<m; j++){
+        sum += ldexp(1., -(int)counter[j]);
+        if (counter[j] == 0)
+            zeros++;
+    }
+    if (m == 16)
+        alpha = 0.673;
+    else if (m == 32)
+        alpha = 0.697;
+    else if (m == 64)
+        alpha = 0.709;
+    else
+        alpha = 0.7213/(1. + 1.079/m);
+    estimate = alpha*m*m/sum;
+    // small range correction (linear counting)
+    if (estimate <= 2.5*m && zeros > 0)
+        estimate = m*log((double)m/(double)zeros);
+    return estimate;
+}
+
+// computing the neighbourhood function N(t) (number of pairs of nodes at distance at most t) and returning the number of iterations
+unsigned long hyperanf(adjlist *g, int b, double **neighbourhood){
+    // m registers of one byte per counter, i.e. m/8 words
+    unsigned long m = 1UL << b, words = m/8;
+    unsigned long t, u, size_neighbourhood = 64;
+    int changed = 1;
+    double t1, t2;
+    uint64_t *counters = malloc(g->n*words*sizeof(uint64_t));
+    uint64_t *next_counters = malloc(g->n*words*sizeof(uint64_t));
+    uint64_t *tmp;
+    *neighbourhood = malloc(size_neighbourhood*sizeof(double));
+    // adding each node to its own counter
+    memset(counters, 0, g->n*words*sizeof(uint64_t));
+    for (u=0; u<g->n; u++){
+        uint64_t h = hash_node(u);
+        uint64_t rest = h << b;
+        unsigned char *registers = (unsigned char *)(counters + u*words);
+        registers[h >> (64-b)] = (rest == 0) ? 64-b+1 : __builtin_clzll(rest)+1;
+    }
+    for (t=0; changed && t<MAX_ITERATIONS; t++){
+        t1 = wall_time();
+        double sum = 0.;
+        changed = 0;
+        if (t > 0){
+            // register-wise maximum over the neighbors' counters
+            #pragma omp parallel for schedule(dynamic, 256) reduction(|:changed)
+            for (u=0; u<g->n; u++){
+                unsigned long i, k;
+                uint64_t *c = next_counters + u*words;
+                memcpy(c, counters + u*words, words*sizeof(uint64_t));
+                for (i=g->cd[u]; i<g->cd[u+1]; i++){
+                    uint64_t *c_v = counters + g->adj[i]*words;
+                    for (k=0; k<words; k++){
+                        c[k] = broadword_max(c[k], c_v[k]);
+                    }
+                }
+                for (k=0; k<words; k++){
+                    if (c[k] != counters[u*words+k]){
+                        changed = 1;
+                        break;
+                    }
+                }
+            }
+            tmp = counters;
+            counters = next_counters;
+            next_counters = tmp;
+        }
+        else{
+            changed = 1;
+        }
+        // estimating N(t)
+        #pragma omp parallel for reduction(+:sum)
+        for (u=0; u<g->n; u++){
+            sum += hll_estimate((unsigned char *)(counters + u*words), m);
+        }
+        if (t == size_neighbourhood){ // increase the neighbourhood function table if needed
+            size_neighbourhood *= 2;
+            *neighbourhood = realloc(*neighbourhood, size_neighbourhood*sizeof(double));
+        }
+        (*neighbourhood)[t] = sum;
+        t2 = wall_time();
+        printf("    -- iteration %lu: N(%lu) = %0.1f in %0.3fs\n", t, t, sum, t2-t1);
+    }
+    free(counters);
+    free(next_counters);
+    // the last iteration did not change any counter (unless MAX_ITERATIONS was reached)
+    return changed ? t-1 : t-2;
+}
+
+int main(int argc, char** argv){
+    // using the adjlist structure
+    adjlist* g;
+    time_t t1,t2;
+    t1=time(NULL);
+    printf("Reading edgelist from file %s\n",argv[1]);
+    g=readedgelist(argv[1]);
+    printf("Number of nodes: %lu\n",g->n);
+    printf("Number of edges: %lu\n",g->e);
+    printf("Building the adjacency list\n");
+    mkadjlist(g);
+    // choosing the largest number of registers such that the two counters of a node fit in the memory budget
+    unsigned long budget = (argc > 3) ? strtoul(argv[3], NULL, 10) : NB_DEFAULT_BYTES;
+    int b = MIN_LOG_REGISTERS;
+    while ((2UL << (b+1)) <= budget && b < 16)
+        b++;
+    printf("HyperANF with %lu registers per counter (%lu bytes per node):\n", 1UL << b, 2UL << b);
+    double *N;
+    unsigned long t, T = hyperanf(g, b, &N);
+    // distance distribution, average distance and effective diameter
+    double pairs = N[T] - N[0], average = 0., effective_diameter = T;
+    for (t=1; t<=T; t++){
+        average += t*(N[t]-N[t-1]);
+    }
+    average /= pairs;
+    for (t=1; t<=T; t++){
+        if (N[t]-N[0] >= PERCENTILE*pairs){
+            // interpolating between t-1 and t
+            effective_diameter = (t-1) + (PERCENTILE*pairs - (N[t-1]-N[0]))/(N[t]-N[t-1]);
+            break;
+        }
+    }
+    printf("Number of iterations: %lu\n", T);
+    printf("Average distance: %f\n", average);
+    printf("Effective diameter: %f\n", effective_diameter);
+    // writing results
+    FILE *f = fopen(argv[2], "w");
+    fprintf(f, "Number of registers per counter: %lu\n", 1UL << b);
+    fprintf(f, "Number of iterations (lower bound to the diameter): %lu\n", T);
+    fprintf(f, "Average distance: %f\n", average);
+    fprintf(f, "Effective diameter: %f\n", effective_diameter);
+    fprintf(f, "\nNeighbourhood function and distance distribution (t, N(t), fraction of pairs at distance t):\n");
+    for (t=0; t<=T; t++){
+        fprintf(f, "%lu %0.1f %0.10f\n", t, N[t], (t > 0) ? (N[t]-N[t-1])/pairs : 0.);
+    }
+    fclose(f);
+    free(N);
+    free_adjlist(g);
+    t2=time(NULL);
+    printf("- Overall time = %ldh%ldm%lds\n",(t2-t1)/3600,((t2-t1)%3600)/60,((t2-t1)%60));
+    return 0;
+}
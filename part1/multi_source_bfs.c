@@ -0,0 +1,292 @@
+/*
+ The program will load the graph in main memory and run BFS from a sample of source nodes, 64 sources at once (256 when compiled with -DMSBFS_WORDS=4): each node holds one bit per source in its `seen` and `visit` bitsets, so that each scan of an adjacency list serves all the sources of the batch. The program expects an argument `edgelist.txt` that should contain the graph: one edge on each line (two unsigned long (nodes' ID) separated by a space); an argument `results.txt` for writing the results; and optionally the number of sampled sources (all the non-isolated nodes if larger than their number, 64 by default). For each source, the program writes its eccentricity, the number of reached nodes, the sum of the distances, its closeness and its distance histogram.
+
+To compile:
+"gcc multi_source_bfs.c -O3 -fopenmp -o multi_source_bfs".
+"gcc multi_source_bfs.c -O3 -fopenmp -mavx2 -DMSBFS_WORDS=4 -o multi_source_bfs" (256 sources at once).
+
+To execute:
+"./multi_source_bfs graphs/edgelist.txt results/edgelist_msbfs.txt 256".
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h> // to estimate the runing time
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define NLINKS 100000000 // maximum number of edges for memory allocation, will increase if needed
+#ifndef MSBFS_WORDS
+#define MSBFS_WORDS 1 // number of 64-bit words of the bitsets of each node
+#endif
+#define NB_SOURCES (64*MSBFS_WORDS) // number of BFS run at once
+#define NB_DEFAULT_SOURCES 64
+
+typedef struct {
+    unsigned long s;
+    unsigned long t;
+} edge;
+
+// edge list structure:
+typedef struct {
+    unsigned long n; // number of nodes
+    unsigned long e; // number of edges
+    edge *edges; // list of edges
+    unsigned long *cd; // cumulative degree cd[0]=0 length=n+1
+    unsigned long *adj; // concatenated lists of neighbors of all nodes
+} adjlist;
+
+// compute the maximum of three unsigned long
+inline unsigned long max3(unsigned long a,unsigned long b,unsigned long c){
+    a=(a>b) ? a : b;
+    return (a>c) ? a : c;
+}
+
+// reading the edgelist from file
+adjlist* readedgelist(char* input){
+    unsigned long e1=NLINKS;
+    FILE *file=fopen(input,"r");
+    adjlist *g=malloc(sizeof(adjlist));
+    g->n=0;
+    g->e=0;
+    g->edges=malloc(e1*sizeof(edge));//allocate some RAM to store edges
+    while (fscanf(file,"%lu %lu", &(g->edges[g->e].s), &(g->edges[g->e].t))==2) {
+        g->n=max3(g->n,g->edges[g->e].s,g->edges[g->e].t);
+        if (++(g->e)==e1) {//increase allocated RAM if needed
+            e1+=NLINKS;
+            g->edges=realloc(g->edges,e1*sizeof(edge));
+        }
+    }
+    fclose(file);
+    g->n++;
+    g->edges=realloc(g->edges,g->e*sizeof(edge));
+    return g;
+}
+
+// building the adjacency matrix
+void mkadjlist(adjlist* g){
+    unsigned long i,u,v;
+    unsigned long *d=calloc(g->n,sizeof(unsigned long));
+    for (i=0;i<g->e;i++) {
+        d[g->edges[i].s]++;
+        d[g->edges[i].t]++;
+    }
+    g->cd=malloc((g->n+1)*sizeof(unsigned long));
+    g->cd[0]=0;
+    for (i=1;i<g->n+1;i++) {
+        g->cd[i]=g->cd[i-1]+d[i-1];
+        d[i-1]=0;
+    }
+    g->adj=malloc(2*g->e*sizeof(unsigned long));
+    for (i=0;i<g->e;i++) {
+        u=g->edges[i].s;
+        v=g->edges[i].t;
+        g->adj[ g->cd[u] + d[u]++ ]=v;
+        g->adj[ g->cd[v] + d[v]++ ]=u;
+    }
+    free(d);
+    // free(g->edges);
+}
+
+// freeing memory
+void free_adjlist(adjlist *g){
+    free(g->edges);
+    free(g->cd);
+    free(g->adj);
+    free(g);
+}
+
+
+// running the BFS from nb_sources (at most NB_SOURCES) sources at once and returning the number of levels
+// counts[l*NB_SOURCES+i] is the number of nodes at distance l from the i-th source
+unsigned long ms_bfs(adjlist *g, unsigned long *sources, unsigned long nb_sources, uint64_t *seen, uint64_t *visit, uint64_t *visit_next, unsigned long **counts){
+    // initializing the level, the size of the counts table (in number of levels) and indexes
+    unsigned long level = 0, size_counts = 64, i, w;
+    int active = 1;
+    uint64_t *tmp;
+    // bits of the sources of the batch
+    uint64_t full[MSBFS_WORDS];
+    for (w=0; w<MSBFS_WORDS; w++){
+        full[w] = 0;
+    }
+    for (i=0; i<nb_sources; i++){
+        full[i/64] |= (uint64_t)1 << (i%64);
+    }
+    *counts = realloc(*counts, size_counts*NB_SOURCES*sizeof(unsigned long));
+    memset(*counts, 0, NB_SOURCES*sizeof(unsigned long));
+    // resetting the bitsets
+    memset(seen, 0, g->n*MSBFS_WORDS*sizeof(uint64_t));
+    memset(visit, 0, g->n*MSBFS_WORDS*sizeof(uint64_t));
+    // each source is at distance 0 of itself
+    for (i=0; i<nb_sources; i++){
+        seen[sources[i]*MSBFS_WORDS + i/64] |= (uint64_t)1 << (i%64);
+        visit[sources[i]*MSBFS_WORDS + i/64] |= (uint64_t)1 << (i%64);
+        (*counts)[i] = 1;
+    }
+    while (active){
+        level++;
+        if (level == size_counts){ // increase the counts table if needed
+            size_counts *= 2;
+            *counts = realloc(*counts, size_counts*NB_SOURCES*sizeof(unsigned long));
+        }
+        memset(*counts + level*NB_SOURCES, 0, NB_SOURCES*sizeof(unsigned long));
+        active = 0;
+        #pragma omp parallel
+        {
+            // thread-local number of nodes reached at this level by each source
+            unsigned long local_counts[NB_SOURCES];
+            unsigned long u, j, k, v;
+            uint64_t next[MSBFS_WORDS], all_seen, any, bits;
+            int local_active = 0;
+            memset(local_counts, 0, NB_SOURCES*sizeof(unsigned long));
+            #pragma omp for schedule(dynamic, 1024)
+            for (u=0; u<g->n; u++){
+                // skipping the nodes already seen by all the sources
+                all_seen = ~(uint64_t)0;
+                for (k=0; k<MSBFS_WORDS; k++){
+                    all_seen &= seen[u*MSBFS_WORDS+k] | ~full[k];
+                    next[k] = 0;
+                }
+                if (all_seen != ~(uint64_t)0){
+                    // pulling the BFS of all the sources visiting one of u's neighbors at the previous level
+                    for (j=g->cd[u]; j<g->cd[u+1]; j++){
+                        v = g->adj[j];
+                        for (k=0; k<MSBFS_WORDS; k++){
+                            next[k] |= visit[v*MSBFS_WORDS+k];
+                        }
+                    }
+                }
+                any = 0;
+                for (k=0; k<MSBFS_WORDS; k++){
+                    // keeping only the BFS reaching u for the first time
+                    next[k] &= ~seen[u*MSBFS_WORDS+k];
+                    seen[u*MSBFS_WORDS+k] |= next[k];
+                    visit_next[u*MSBFS_WORDS+k] = next[k];
+                    any |= next[k];
+                }
+                if (any){
+                    local_active = 1;
+                    for (k=0; k<MSBFS_WORDS; k++){
+                        bits = next[k];
+                        while (bits){
+                            local_counts[k*64 + __builtin_ctzll(bits)]++;
+                            bits &= bits - 1;
+                        }
+                    }
+                }
+            }
+            #pragma omp critical
+            {
+                for (k=0; k<nb_sources; k++){
+                    (*counts)[level*NB_SOURCES+k] += local_counts[k];
+                }
+                active |= local_active;
+            }
+        }
+        // the next level becomes the current level
+        tmp = visit;
+        visit = visit_next;
+        visit_next = tmp;
+    }
+    return level;
+}
+
+// choosing nb_sources random nodes among the non-isolated nodes (all of them if there are not enough)
+unsigned long sample_sources(adjlist *g, unsigned long nb_sources, unsigned long *sources){
+    unsigned long u, i, j, tmp, nb_candidates = 0;
+    for (u=0; u<g->n; u++){
+        if (g->cd[u+1] > g->cd[u])
+            sources[nb_candidates++] = u;
+    }
+    if (nb_sources > nb_candidates)
+        nb_sources = nb_candidates;
+    // partial Fisher-Yates shuffle
+    srand(time(NULL));
+    for (i=0; i<nb_sources; i++){
+        j = i + (unsigned long)rand() % (nb_candidates - i);
+        tmp = sources[i];
+        sources[i] = sources[j];
+        sources[j] = tmp;
+    }
+    return nb_sources;
+}
+
+int main(int argc, char** argv){
+    // using the adjlist structure
+    adjlist* g;
+    time_t t1,t2;
+    t1=time(NULL);
+    printf("Reading edgelist from file %s\n",argv[1]);
+    g=readedgelist(argv[1]);
+    printf("Number of nodes: %lu\n",g->n);
+    printf("Number of edges: %lu\n",g->e);
+    printf("Building the adjacency list\n");
+    mkadjlist(g);
+    // initialisation
+    unsigned long nb_sources = (argc > 3) ? strtoul(argv[3], NULL, 10) : NB_DEFAULT_SOURCES;
+    unsigned long i, b, l, nb_batch, nb_levels, eccentricity, reached, sum;
+    unsigned long max_eccentricity = 0, total_levels = 0;
+    unsigned long *sources = malloc(g->n*sizeof(unsigned long));
+    unsigned long *counts = NULL;
+    // distance histogram of all the sources
+    unsigned long *histogram = NULL;
+    // bitsets of the nodes
+    uint64_t *seen = malloc(g->n*MSBFS_WORDS*sizeof(uint64_t));
+    uint64_t *visit = malloc(g->n*MSBFS_WORDS*sizeof(uint64_t));
+    uint64_t *visit_next = malloc(g->n*MSBFS_WORDS*sizeof(uint64_t));
+    nb_sources = sample_sources(g, nb_sources, sources);
+    printf("Multi-source BFS from %lu sources, %d at once:\n", nb_sources, NB_SOURCES);
+    FILE *f = fopen(argv[2], "w");
+    fprintf(f, "Per-source results (node, eccentricity, number of reached nodes, sum of the distances, closeness, then the number of nodes at distance 1, 2, ...):\n");
+    for (b=0; b<nb_sources; b+=NB_SOURCES){
+        nb_batch = (nb_sources - b < NB_SOURCES) ? nb_sources - b : NB_SOURCES;
+        nb_levels = ms_bfs(g, sources + b, nb_batch, seen, visit, visit_next, &counts);
+        printf("    -- sources %lu to %lu: %lu levels\n", b+1, b+nb_batch, nb_levels-1);
+        if (nb_levels > total_levels){ // increase the histogram if needed
+            histogram = realloc(histogram, nb_levels*sizeof(unsigned long));
+            for (l=total_levels; l<nb_levels; l++){
+                histogram[l] = 0;
+            }
+            total_levels = nb_levels;
+        }
+        for (i=0; i<nb_batch; i++){
+            eccentricity = 0;
+            reached = 0;
+            sum = 0;
+            for (l=0; l<nb_levels; l++){
+                if (counts[l*NB_SOURCES+i] > 0)
+                    eccentricity = l;
+                reached += counts[l*NB_SOURCES+i];
+                sum += l*counts[l*NB_SOURCES+i];
+                histogram[l] += counts[l*NB_SOURCES+i];
+            }
+            if (eccentricity > max_eccentricity)
+                max_eccentricity = eccentricity;
+            fprintf(f, "%lu %lu %lu %lu %0.10f", sources[b+i], eccentricity, reached, sum, (sum > 0) ? (double)(reached-1)/(double)sum : 0.);
+            for (l=1; l<=eccentricity; l++){
+                fprintf(f, " %lu", counts[l*NB_SOURCES+i]);
+            }
+            fprintf(f, "\n");
+        }
+    }
+    printf("Lower bound to the diameter: %lu\n", max_eccentricity);
+    fprintf(f, "\nLower bound to the diameter: %lu\n", max_eccentricity);
+    fprintf(f, "\nDistance histogram of all the sources (distance, number of pairs):\n");
+    for (l=1; l<=max_eccentricity; l++){
+        fprintf(f, "%lu %lu\n", l, histogram[l]);
+    }
+    fclose(f);
+    free(sources);
+    free(counts);
+    free(histogram);
+    free(seen);
+    free(visit);
+    free(visit_next);
+    free_adjlist(g);
+    t2=time(NULL);
+    printf("- Overall time = %ldh%ldm%lds\n",(t2-t1)/3600,((t2-t1)%3600)/60,((t2-t1)%60));
+    return 0;
+}
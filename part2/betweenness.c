@@ -0,0 +1,360 @@
+/*
+The program is the implementation of Brandes' algorithm for betweenness centrality, run in parallel from all the nodes or from a sample of source nodes. The graph is considered as undirected.
+
+The program expects the following arguments:
+- edgelist.txt that should contain the graph: one edge on each line (two unsigned long (nodes' ID) separated by a space);
+- results.txt for writing the results of the betweenness algorithm;
+- optionally, the number of sampled sources (0 or no argument for all the nodes);
+- optionally, a number k of top nodes: sources are then sampled by batches until the k nodes with the highest betweenness are separated from the others with 99% confidence (or the number of sampled sources is reached).
+ 
+To compile:
+"gcc betweenness.c -O3 -fopenmp -lm -o betweenness".
+
+To execute:
+"./betweenness graphs/tuto_graph.txt results/tuto_betweenness.txt".
+"./betweenness graphs/edgelist.txt results/edgelist_betweenness.txt 10000 20".
+*/
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include <time.h> // to estimate the runing time
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#define omp_get_thread_num() 0
+#endif
+
+#define NB_RESULTS 5
+#define BATCH_SOURCES 64 // number of sources between two confidence tests in adaptive mode
+#define CONFIDENCE_Z 2.576 // 99% two-sided normal quantile
+#define NLINKS 100000000 // maximum number of edges for memory allocation, will increase if needed
+
+typedef struct {
+    unsigned long node;
+    double score;
+} betweenness;
+
+typedef struct {
+    unsigned long s;
+    unsigned long t;
+} edge;
+
+// edge list structure:
+typedef struct {
+    unsigned long n; // number of nodes
+    unsigned long e; // number of edges
+    edge *edges; // list of edges
+    unsigned long *cd; // cumulative degree cd[0]=0 length=n+1
+    unsigned long *adj; // concatenated lists of neighbors of all nodes
+} adjlist;
+
+// compute the maximum of three unsigned long
+inline unsigned long max3(unsigned long a,unsigned long b,unsigned long c){
+    a=(a>b) ? a : b;
+    return (a>c) ? a : c;
+}
+
+// reading the edgelist from file
+adjlist* readedgelist(char* input){
+    unsigned long e1=NLINKS;
+    FILE *file=fopen(input,"r");
+    adjlist *g=malloc(sizeof(adjlist));
+    g->n=0;
+    g->e=0;
+    g->edges=malloc(e1*sizeof(edge));//allocate some RAM to store edges
+    while (fscanf(file,"%lu %lu", &(g->edges[g->e].s), &(g->edges[g->e].t))==2) {
+        g->n=max3(g->n,g->edges[g->e].s,g->edges[g->e].t);
+        if (++(g->e)==e1) {//increase allocated RAM if needed
+            e1+=NLINKS;
+            g->edges=realloc(g->edges,e1*sizeof(edge));
+        }
+    }
+    fclose(file);
+    g->n++;
+    g->edges=realloc(g->edges,g->e*sizeof(edge));
+    return g;
+}
+
+// building the adjacency matrix
+void mkadjlist(adjlist* g){
+    unsigned long i,u,v;
+    unsigned long *d=calloc(g->n,sizeof(unsigned long));
+    for (i=0;i<g->e;i++) {
+        d[g->edges[i].s]++;
+        d[g->edges[i].t]++;
+    }
+    g->cd=malloc((g->n+1)*sizeof(unsigned long));
+    g->cd[0]=0;
+    for (i=1;i<g->n+1;i++) {
+        g->cd[i]=g->cd[i-1]+d[i-1];
+        d[i-1]=0;
+    }
+    g->adj=malloc(2*g->e*sizeof(unsigned long));
+    for (i=0;i<g->e;i++) {
+        u=g->edges[i].s;
+        v=g->edges[i].t;
+        g->adj[ g->cd[u] + d[u]++ ]=v;
+        g->adj[ g->cd[v] + d[v]++ ]=u;
+    }
+    free(d);
+}
+
+// freeing memory
+void free_adjlist(adjlist *g){
+    free(g->edges);
+    free(g->cd);
+    free(g->adj);
+    free(g);
+}
+
+// per-thread workspace of Brandes' algorithm
+typedef struct {
+    unsigned long *dist; // distance from the source, ULONG_MAX if not reached
+    double *sigma; // number of shortest paths from the source
+    double *delta; // dependency of the source on each node
+    unsigned long *order; // nodes in BFS order, used as FIFO then as stack
+    double *score; // accumulated dependencies
+    double *score2; // accumulated squared dependencies (adaptive mode)
+} workspace;
+
+workspace* alloc_workspace(adjlist *g){
+    unsigned long i;
+    workspace *w = malloc(sizeof(workspace));
+    w->dist = malloc(g->n*sizeof(unsigned long));
+    w->sigma = calloc(g->n, sizeof(double));
+    w->delta = calloc(g->n, sizeof(double));
+    w->order = malloc(g->n*sizeof(unsigned long));
+    w->score = calloc(g->n, sizeof(double));
+    w->score2 = calloc(g->n, sizeof(double));
+    for (i=0; i<g->n; i++){
+        w->dist[i] = ULONG_MAX;
+    }
+    return w;
+}
+
+void free_workspace(workspace *w){
+    free(w->dist);
+    free(w->sigma);
+    free(w->delta);
+    free(w->order);
+    free(w->score);
+    free(w->score2);
+    free(w);
+}
+
+// accumulating the dependencies of the source s on every node (Brandes' algorithm)
+void brandes(adjlist *g, unsigned long s, workspace *w){
+    unsigned long b = 0, e = 0, i, u, v, x;
+    // BFS counting the shortest paths
+    w->order[e++] = s;
+    w->dist[s] = 0;
+    w->sigma[s] = 1.;
+    while (b != e){
+        u = w->order[b++];
+        for (i=g->cd[u]; i<g->cd[u+1]; i++){
+            v = g->adj[i];
+            if (w->dist[v] == ULONG_MAX){
+                w->dist[v] = w->dist[u] + 1;
+                w->order[e++] = v;
+            }
+            if (w->dist[v] == w->dist[u] + 1){
+                w->sigma[v] += w->sigma[u];
+            }
+        }
+    }
+    // back-propagation of the dependencies in reverse BFS order (the predecessors of u are its neighbors one level closer)
+    while (e > 0){
+        u = w->order[--e];
+        for (i=g->cd[u]; i<g->cd[u+1]; i++){
+            v = g->adj[i];
+            if (w->dist[v] + 1 == w->dist[u]){
+                w->delta[v] += w->sigma[v]/w->sigma[u]*(1. + w->delta[u]);
+            }
+        }
+        if (u != s){
+            w->score[u] += w->delta[u];
+            w->score2[u] += w->delta[u]*w->delta[u];
+        }
+    }
+    // resetting the reached nodes
+    while (b > 0){
+        x = w->order[--b];
+        w->dist[x] = ULONG_MAX;
+        w->sigma[x] = 0.;
+        w->delta[x] = 0.;
+    }
+}
+
+// running Brandes' algorithm from the sources in parallel and adding the dependencies to score and score2
+void run_sources(adjlist *g, unsigned long *sources, unsigned long nb_sources, workspace **w, double *score, double *score2){
+    int nb_threads = omp_get_max_threads();
+    unsigned long i;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (i=0; i<nb_sources; i++){
+        brandes(g, sources[i], w[omp_get_thread_num()]);
+    }
+    // reduction of the per-thread accumulators
+    #pragma omp parallel for
+    for (i=0; i<g->n; i++){
+        int t;
+        for (t=0; t<nb_threads; t++){
+            score[i] += w[t]->score[i];
+            score2[i] += w[t]->score2[i];
+            w[t]->score[i] = 0.;
+            w[t]->score2[i] = 0.;
+        }
+    }
+}
+
+// comparing 2 elements
+static int compare_scores(void const *e1, void const *e2){
+    betweenness const *element1 = e1;
+    betweenness const *element2 = e2;
+    if (element1->score - element2->score > 0)
+        return -1;
+    else if (element1->score - element2->score < 0)
+        return 1;
+    else
+        return 0;
+}
+
+// testing whether the k nodes with the highest estimated betweenness are separated from the others with CONFIDENCE_Z
+int top_k_confident(adjlist *g, double *score, double *score2, unsigned long nb_sources, unsigned long k, betweenness *ranking){
+    unsigned long i, v;
+    double mean, variance, half_width, min_lower = INFINITY, max_upper = -INFINITY;
+    double *half_widths = malloc(g->n*sizeof(double));
+    // the dependency of a random source on v is an unbiased estimator of the betweenness of v divided by n
+    for (v=0; v<g->n; v++){
+        mean = score[v]/nb_sources;
+        variance = (score2[v] - nb_sources*mean*mean)/(nb_sources - 1);
+        // the sources are sampled without replacement (finite population correction)
+        variance *= (double)(g->n - nb_sources)/(double)(g->n - 1);
+        half_widths[v] = CONFIDENCE_Z*sqrt((variance > 0.) ? variance/nb_sources : 0.);
+        ranking[v].node = v;
+        ranking[v].score = mean;
+    }
+    qsort(ranking, g->n, sizeof(betweenness), compare_scores);
+    for (i=0; i<g->n; i++){
+        half_width = half_widths[ranking[i].node];
+        if (i < k && ranking[i].score - half_width < min_lower)
+            min_lower = ranking[i].score - half_width;
+        if (i >= k && ranking[i].score + half_width > max_upper)
+            max_upper = ranking[i].score + half_width;
+    }
+    free(half_widths);
+    return min_lower > max_upper;
+}
+
+int main(int argc, char** argv){
+    // using the adjlist structure
+    adjlist* g;
+    time_t t1,t2;
+    t1=time(NULL);
+    printf("Reading edgelist from file %s\n",argv[1]);
+    g=readedgelist(argv[1]);
+    printf("Number of nodes: %lu\n",g->n);
+    printf("Number of edges: %lu\n",g->e);
+    printf("Building the adjacency list\n");
+    mkadjlist(g);
+    // initialisation
+    unsigned long nb_sources = (argc > 3) ? strtoul(argv[3], NULL, 10) : 0;
+    unsigned long k = (argc > 4) ? strtoul(argv[4], NULL, 10) : 0;
+    unsigned long i, j, tmp, done = 0, nb_results;
+    int t, nb_threads = omp_get_max_threads();
+    double scale;
+    double *score = calloc(g->n, sizeof(double));
+    double *score2 = calloc(g->n, sizeof(double));
+    unsigned long *sources = malloc(g->n*sizeof(unsigned long));
+    betweenness *ranking = malloc(g->n*sizeof(betweenness));
+    workspace **w = malloc(nb_threads*sizeof(workspace*));
+    for (t=0; t<nb_threads; t++){
+        w[t] = alloc_workspace(g);
+    }
+    if (nb_sources == 0 || nb_sources > g->n)
+        nb_sources = g->n;
+    if (k >= g->n)
+        k = 0;
+    // random order of the sources (partial Fisher-Yates shuffle)
+    for (i=0; i<g->n; i++){
+        sources[i] = i;
+    }
+    if (nb_sources < g->n || k > 0){
+        srand(time(NULL));
+        for (i=0; i<nb_sources; i++){
+            j = i + (unsigned long)rand() % (g->n - i);
+            tmp = sources[i];
+            sources[i] = sources[j];
+            sources[j] = tmp;
+        }
+    }
+    if (k > 0){
+        // adaptive sampling: batches of sources until the top-k ranking is confident
+        printf("Adaptive sampling for the top %lu nodes (at most %lu sources):\n", k, nb_sources);
+        while (done < nb_sources){
+            j = (nb_sources - done < BATCH_SOURCES) ? nb_sources - done : BATCH_SOURCES;
+            run_sources(g, sources + done, j, w, score, score2);
+            done += j;
+            if (done > 1 && top_k_confident(g, score, score2, done, k, ranking)){
+                printf("    -- %lu sources: top %lu nodes separated with 99%% confidence\n", done, k);
+                break;
+            }
+            printf("    -- %lu sources: top %lu nodes not yet separated\n", done, k);
+        }
+    }
+    else{
+        printf("Brandes' algorithm from %lu sources:\n", nb_sources);
+        run_sources(g, sources, nb_sources, w, score, score2);
+        done = nb_sources;
+    }
+    printf("Computing betweenness: done.\n");
+    // scaling the sums of dependencies (each pair of nodes is counted twice in an undirected graph)
+    scale = (double)g->n/(double)done/2.;
+    for (i=0; i<g->n; i++){
+        ranking[i].node = i;
+        ranking[i].score = score[i]*scale;
+    }
+    qsort(ranking, g->n, sizeof(betweenness), compare_scores);
+    printf("Sorting score: done.\n");
+    nb_results = (k > 0) ? k : NB_RESULTS;
+    if (nb_results > g->n)
+        nb_results = g->n;
+    // printing results
+    printf("\nBetweenness results with %lu sources:\n", done);
+    printf("\nThe %lu nodes with the highest betweenness:\n", nb_results);
+    for (i=0; i<nb_results; i++){
+        printf("%lu: ", i+1);
+        printf("Node %lu ", ranking[i].node);
+        printf("with score %0.10f\n", ranking[i].score);
+    }
+    // writing results in file
+    FILE *f = fopen(argv[2], "w");
+    fprintf(f, "Betweenness results with %lu sources:\n", done);
+    fprintf(f, "\nThe %lu nodes with the highest betweenness:\n", nb_results);
+    for (i=0; i<nb_results; i++){
+        fprintf(f, "%lu: ", i+1);
+        fprintf(f, "Node %lu ", ranking[i].node);
+        fprintf(f, "with score %0.10f\n", ranking[i].score);
+    }
+    fprintf(f, "\nFull betweenness results:\n");
+    for (i=0; i<g->n; i++){
+        fprintf(f, "%lu %0.15f\n", i, score[i]*scale);
+    }
+    fclose(f);
+    for (t=0; t<nb_threads; t++){
+        free_workspace(w[t]);
+    }
+    free(w);
+    free(score);
+    free(score2);
+    free(sources);
+    free(ranking);
+    free_adjlist(g);
+    t2=time(NULL);
+    printf("\n- Overall time = %ldh%ldm%lds\n",(t2-t1)/3600,((t2-t1)%3600)/60,((t2-t1)%60));
+    return 0;
+}
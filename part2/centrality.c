@@ -0,0 +1,499 @@
+/*
+The program computes centralities of the nodes of a directed graph with a common power iteration engine on the adjacency matrix A: PageRank, HITS (authorities and hubs), Katz and eigenvector centrality. The graph is read once and stored as the in-adjacency list (A in compressed sparse column format: the in-neighbors of each node) and the out-adjacency list (A in compressed sparse row format). Each centrality is a step built on the same parallel sparse matrix-vector product (each thread gathers a range of rows balanced by number of entries), followed by a normalisation of its vectors (norm 1, norm 2 or none) and a relative L1 convergence test; the time and the throughput (edges/s) of each iteration are displayed.
+
+The program expects the following arguments:
+- edgelist.txt that should contain the graph: one edge on each line (two unsigned long (nodes' ID) separated by a space);
+- results.txt for writing the scores of each node (one column per vector);
+- optionally, the centrality: pagerank, hits, katz, eigenvector or all (default);
+- optionally, the number k of nodes with the highest score to display for each vector (5 by default).
+
+To compile:
+"gcc centrality.c -O3 -fopenmp -lm -o centrality".
+
+To execute:
+"./centrality graphs/tuto_graph.txt results/tuto_centrality.txt".
+"./centrality graphs/tuto_graph.txt results/tuto_hits.txt hits 3".
+*/
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>//to estimate the runing time
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#define omp_get_thread_num() 0
+#endif
+
+#define ALPHA 0.15 //teleportation probability of PageRank
+#define KATZ_FACTOR 0.9 //attenuation factor of Katz as a fraction of 1/(bound of the spectral radius of A)
+#define KATZ_BETA 1.
+#define NB_ITERATIONS 200
+#define EPSILON 0.00000001
+#define NB_RESULTS 5
+#define MAX_VECTORS 2
+#define NLINKS 100000000 //maximum number of edges for memory allocation, will increase if needed
+
+#define NORM_NONE 0
+#define NORM_1 1
+#define NORM_2 2
+
+typedef struct {
+    unsigned long node;
+    double score;
+} node_score;
+
+typedef struct {
+    unsigned long s;
+    unsigned long t;
+} edge;
+
+//edge list structure:
+typedef struct {
+    unsigned long n;//number of nodes
+    unsigned long e;//number of edges
+    edge *edges;//list of edges
+} edgelist;
+
+//sparse 0/1 matrix in compressed rows: the columns of the non-zero entries of row i are adj[cd[i]], ..., adj[cd[i+1]-1]
+//the in-adjacency list is A in compressed columns (the rows of A^T), the out-adjacency list is A in compressed rows
+typedef struct {
+    unsigned long n;//number of rows
+    unsigned long e;//number of non-zero entries
+    unsigned long *cd;//cumulative number of entries cd[0]=0 length=n+1
+    unsigned long *adj;//concatenated columns of all rows
+    int nb_parts;//number of row partitions, one per thread
+    unsigned long *bounds;//rows [bounds[p], bounds[p+1]) of partition p
+} sparse;
+
+//graph loaded once and shared by all the centralities
+typedef struct {
+    unsigned long n;
+    unsigned long e;
+    sparse in;//A in CSC format: y = A^T.x sums x over the in-neighbors
+    sparse out;//A in CSR format: y = A.x sums x over the out-neighbors
+    double *inv_degree;//1/out-degree, 0 for the dead ends
+    double *work;//buffer of n doubles for the steps
+    double katz_alpha;
+} graph;
+
+//a centrality: nb_vectors vectors of n doubles, computed by iterating step (y from x), each vector being normalised with norm
+typedef struct {
+    char *name;
+    unsigned long nb_vectors;
+    char *vector_names[MAX_VECTORS];
+    int norm;
+    unsigned long nb_products;//number of matrix-vector products per step
+    void (*step)(graph *g, double *x, double *y);
+} centrality;
+
+//compute the maximum of three unsigned long
+inline unsigned long max3(unsigned long a,unsigned long b,unsigned long c){
+    a=(a>b) ? a : b;
+    return (a>c) ? a : c;
+}
+
+//reading the edgelist from file
+edgelist* readedgelist(char* input){
+    unsigned long e1=NLINKS;
+    FILE *file=fopen(input,"r");
+    edgelist *g=malloc(sizeof(edgelist));
+    g->n=0;
+    g->e=0;
+    g->edges=malloc(e1*sizeof(edge));//allocate some RAM to store edges
+    while (fscanf(file,"%lu %lu", &(g->edges[g->e].s), &(g->edges[g->e].t))==2) {
+        g->n=max3(g->n,g->edges[g->e].s,g->edges[g->e].t);
+        if (++(g->e)==e1) {//increase allocated RAM if needed
+            e1+=NLINKS;
+            g->edges=realloc(g->edges,e1*sizeof(edge));
+        }
+    }
+    fclose(file);
+    g->n++;
+    g->edges=realloc(g->edges,g->e*sizeof(edge));
+    return g;
+}
+
+double wall_time(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+//splitting the n rows into nb_parts ranges [bounds[p], bounds[p+1]) of about the same number of entries + rows
+void partition_rows(unsigned long *cd, unsigned long n, unsigned long e, unsigned long nb_parts, unsigned long *bounds){
+    unsigned long p, lo, hi, mid, target;
+    bounds[0] = 0;
+    for (p=1; p<nb_parts; p++){
+        // first row v with cd[v] + v >= p * (e + n) / nb_parts
+        target = (unsigned long)((double)p * (e + n) / nb_parts);
+        lo = bounds[p-1];
+        hi = n;
+        while (lo < hi){
+            mid = lo + (hi-lo)/2;
+            if (cd[mid] + mid < target)
+                lo = mid+1;
+            else
+                hi = mid;
+        }
+        bounds[p] = lo;
+    }
+    bounds[nb_parts] = n;
+}
+
+//building the compressed rows of the matrix with an entry (s, t) for each edge (transpose: (t, s)), in the order of the edge list
+//partition p is first touched (hence allocated on the NUMA node) by thread p, which reads it in spmv
+void mksparse(edgelist *el, int transpose, sparse *m){
+    int nb_threads = omp_get_max_threads(), p;
+    unsigned long i, u, v;
+    unsigned long *d = calloc(el->n, sizeof(unsigned long));
+    unsigned long *adj;
+    m->n = el->n;
+    m->e = el->e;
+    for (i=0; i<el->e; i++){
+        d[transpose ? el->edges[i].t : el->edges[i].s]++;
+    }
+    m->cd = malloc((el->n+1)*sizeof(unsigned long));
+    m->cd[0] = 0;
+    for (i=1; i<el->n+1; i++){
+        m->cd[i] = m->cd[i-1] + d[i-1];
+        d[i-1] = 0;
+    }
+    adj = malloc(el->e*sizeof(unsigned long));
+    for (i=0; i<el->e; i++){
+        u = transpose ? el->edges[i].t : el->edges[i].s;
+        v = transpose ? el->edges[i].s : el->edges[i].t;
+        adj[ m->cd[u] + d[u]++ ] = v;
+    }
+    free(d);
+    m->nb_parts = nb_threads;
+    m->bounds = malloc((nb_threads+1)*sizeof(unsigned long));
+    partition_rows(m->cd, m->n, m->e, nb_threads, m->bounds);
+    m->adj = malloc(el->e*sizeof(unsigned long));
+    //the loop is over the partitions, so that they are all copied even if the team is smaller than nb_threads
+    #pragma omp parallel for schedule(static, 1) num_threads(nb_threads)
+    for (p=0; p<nb_threads; p++){
+        memcpy(m->adj+m->cd[m->bounds[p]], adj+m->cd[m->bounds[p]], (m->cd[m->bounds[p+1]]-m->cd[m->bounds[p]])*sizeof(unsigned long));
+    }
+    free(adj);
+}
+
+void free_sparse(sparse *m){
+    free(m->cd);
+    free(m->adj);
+    free(m->bounds);
+}
+
+//building both compressed formats, the inverse out-degrees and the Katz attenuation factor from the edge list
+graph* mkgraph(edgelist *el){
+    unsigned long i, d, max_in = 0, max_out = 0;
+    graph *g = malloc(sizeof(graph));
+    g->n = el->n;
+    g->e = el->e;
+    mksparse(el, 1, &g->in);
+    mksparse(el, 0, &g->out);
+    g->inv_degree = malloc(g->n*sizeof(double));
+    g->work = malloc(g->n*sizeof(double));
+    for (i=0; i<g->n; i++){
+        d = g->out.cd[i+1] - g->out.cd[i];
+        g->inv_degree[i] = (d == 0) ? 0. : 1./d;
+        max_out = (d > max_out) ? d : max_out;
+        d = g->in.cd[i+1] - g->in.cd[i];
+        max_in = (d > max_in) ? d : max_in;
+    }
+    // the spectral radius of A is at most its largest row sum and its largest column sum
+    d = (max_in < max_out) ? max_in : max_out;
+    g->katz_alpha = KATZ_FACTOR / ((d == 0) ? 1 : d);
+    return g;
+}
+
+void free_graph(graph *g){
+    free_sparse(&g->in);
+    free_sparse(&g->out);
+    free(g->inv_degree);
+    free(g->work);
+    free(g);
+}
+
+//the engine: y = M.x, y[i] being the sum of x over the columns of row i of M, partition p being computed by thread p as in mksparse
+void spmv(sparse *m, double *x, double *y){
+    int p;
+    #pragma omp parallel for schedule(static, 1) num_threads(m->nb_parts)
+    for (p=0; p<m->nb_parts; p++){
+        unsigned long i, j;
+        double sum;
+        for (i=m->bounds[p]; i<m->bounds[p+1]; i++){
+            sum = 0.;
+            for (j=m->cd[i]; j<m->cd[i+1]; j++){
+                sum += x[m->adj[j]];
+            }
+            y[i] = sum;
+        }
+    }
+}
+
+//dividing x (n doubles) by its norm, returns the norm
+double normalise(double *x, unsigned long n, int norm){
+    unsigned long i;
+    double s = 0.;
+    if (norm == NORM_NONE)
+        return 1.;
+    #pragma omp parallel for reduction(+:s)
+    for (i=0; i<n; i++){
+        s += (norm == NORM_1) ? fabs(x[i]) : x[i]*x[i];
+    }
+    if (norm == NORM_2){
+        s = sqrt(s);
+    }
+    if (s == 0.)
+        return 0.;
+    #pragma omp parallel for
+    for (i=0; i<n; i++){
+        x[i] /= s;
+    }
+    return s;
+}
+
+//relative L1 distance between y and x (n doubles): |y-x|_1 / |y|_1
+double distance(double *x, double *y, unsigned long n){
+    unsigned long i;
+    double diff = 0., s = 0.;
+    #pragma omp parallel for reduction(+:diff,s)
+    for (i=0; i<n; i++){
+        diff += fabs(y[i] - x[i]);
+        s += fabs(y[i]);
+    }
+    return (s == 0.) ? diff : diff / s;
+}
+
+//PageRank: y = (1-ALPHA) * (A^T.D^-1.x + dangling) + ALPHA * I, the mass of the dead ends being spread uniformly
+void pagerank_step(graph *g, double *x, double *y){
+    unsigned long i;
+    double dangling = 0.;
+    #pragma omp parallel for reduction(+:dangling)
+    for (i=0; i<g->n; i++){
+        g->work[i] = x[i] * g->inv_degree[i];
+        if (g->inv_degree[i] == 0.){
+            dangling += x[i];
+        }
+    }
+    spmv(&g->in, g->work, y);
+    #pragma omp parallel for
+    for (i=0; i<g->n; i++){
+        y[i] = (1-ALPHA) * (y[i] + dangling / g->n) + ALPHA / g->n;
+    }
+}
+
+//HITS: x holds the authorities then the hubs, the new authorities are A^T.hubs and the new hubs A.authorities (with the new authorities)
+void hits_step(graph *g, double *x, double *y){
+    spmv(&g->in, x+g->n, y);
+    normalise(y, g->n, NORM_2);
+    spmv(&g->out, y, y+g->n);
+}
+
+//Katz: y = katz_alpha * A^T.x + KATZ_BETA, converging as katz_alpha is below 1/(spectral radius of A)
+void katz_step(graph *g, double *x, double *y){
+    unsigned long i;
+    spmv(&g->in, x, y);
+    #pragma omp parallel for
+    for (i=0; i<g->n; i++){
+        y[i] = g->katz_alpha * y[i] + KATZ_BETA;
+    }
+}
+
+//eigenvector centrality: y = (A^T + I).x, the shift by the identity has the same dominant eigenvector as A^T and removes the oscillations of periodic graphs
+void eigenvector_step(graph *g, double *x, double *y){
+    unsigned long i;
+    spmv(&g->in, x, y);
+    #pragma omp parallel for
+    for (i=0; i<g->n; i++){
+        y[i] += x[i];
+    }
+}
+
+centrality centralities[] = {
+    {"pagerank", 1, {"pagerank"}, NORM_1, 1, pagerank_step},
+    {"hits", 2, {"authority", "hub"}, NORM_2, 2, hits_step},
+    {"katz", 1, {"katz"}, NORM_NONE, 1, katz_step},
+    {"eigenvector", 1, {"eigenvector"}, NORM_2, 1, eigenvector_step},
+};
+#define NB_CENTRALITIES (sizeof(centralities)/sizeof(centrality))
+
+//power iteration of the centrality c from the uniform vectors until the relative L1 distance between two iterates is below EPSILON
+//returns the nb_vectors*n scores, t being the number of iterations and converged being set to 0 if EPSILON was not reached
+double* power_method(graph *g, centrality *c, unsigned long *t, int *converged){
+    unsigned long i, k, it, nb_iterations = *t, size = c->nb_vectors*g->n;
+    double *x = malloc(size*sizeof(double));
+    double *y = malloc(size*sizeof(double));
+    double *tmp, cvg, time_it, time_total = 0.;
+    for (i=0; i<size; i++){
+        x[i] = 1./g->n;
+    }
+    for (k=0; k<c->nb_vectors; k++){
+        normalise(x+k*g->n, g->n, c->norm);
+    }
+    for (it=0; it<nb_iterations; it++){
+        time_it = wall_time();
+        c->step(g, x, y);
+        for (k=0; k<c->nb_vectors; k++){
+            normalise(y+k*g->n, g->n, c->norm);
+        }
+        cvg = distance(x, y, size);
+        tmp = x;
+        x = y;
+        y = tmp;
+        time_it = wall_time() - time_it;
+        time_total += time_it;
+        printf("Iteration %lu: cvg = %e, time = %0.3f s, %0.3e edges/s\n", it, cvg, time_it, c->nb_products*g->e/time_it);
+        if (cvg < EPSILON){
+            break;
+        }
+    }
+    *converged = (it < nb_iterations);
+    if (!*converged){
+        printf("No convergence after %lu iterations\n", nb_iterations);
+        it--;
+    }
+    //it is the index of the last iteration
+    *t = it+1;
+    printf("Average throughput: %0.3e edges/s\n", time_total > 0. ? (it+1)*c->nb_products*(double)g->e/time_total : 0.);
+    free(y);
+    return x;
+}
+
+// ranking order: decreasing score, then increasing node ID
+static inline int ranks_before(node_score a, node_score b){
+    return a.score > b.score || (a.score == b.score && a.node < b.node);
+}
+
+// moving down the element at position i of a heap of size size whose root is its lowest element
+static void sift_down(node_score *heap, unsigned long size, unsigned long i){
+    unsigned long child;
+    node_score tmp;
+    while ((child = 2*i+1) < size){
+        if (child+1 < size && ranks_before(heap[child], heap[child+1]))
+            child++;
+        if (!ranks_before(heap[i], heap[child]))
+            break;
+        tmp = heap[i];
+        heap[i] = heap[child];
+        heap[child] = tmp;
+        i = child;
+    }
+}
+
+// finding the k nodes with the highest scores with a heap of size k, in O(n log k), selected is sorted from the highest to the lowest
+void select_k(double *P, unsigned long n, unsigned long k, node_score *selected){
+    unsigned long i, size = 0, j;
+    node_score x, tmp;
+    for (i=0; i<n; i++){
+        x.node = i;
+        x.score = P[i];
+        if (size < k){
+            j = size++;
+            selected[j] = x;
+            while (j > 0 && ranks_before(selected[(j-1)/2], selected[j])){
+                tmp = selected[j];
+                selected[j] = selected[(j-1)/2];
+                selected[(j-1)/2] = tmp;
+                j = (j-1)/2;
+            }
+        }
+        else if (k > 0 && ranks_before(x, selected[0])){
+            selected[0] = x;
+            sift_down(selected, size, 0);
+        }
+    }
+    while (size > 1){
+        tmp = selected[0];
+        selected[0] = selected[--size];
+        selected[size] = tmp;
+        sift_down(selected, size, 0);
+    }
+}
+
+int main(int argc, char** argv){
+    edgelist* el;
+    graph *g;
+    time_t t1,t2;
+    t1=time(NULL);
+    printf("Reading edgelist from file %s\n", argv[1]);
+    el=readedgelist(argv[1]);
+    printf("Number of nodes: %lu\n",el->n);
+    printf("Number of edges: %lu\n",el->e);
+    printf("Building the in- and out-adjacency lists\n");
+    g=mkgraph(el);
+    free(el->edges);
+    free(el);
+    printf("Number of threads: %d\n", omp_get_max_threads());
+    // initialisation
+    char *name = (argc > 3) ? argv[3] : "all";
+    unsigned long k = (argc > 4) ? strtoul(argv[4], NULL, 10) : NB_RESULTS;
+    unsigned long i, j, c, v, nb_columns = 0;
+    unsigned long it[NB_CENTRALITIES];
+    int converged;
+    double *scores[NB_CENTRALITIES];
+    double *columns[NB_CENTRALITIES*MAX_VECTORS];
+    char *column_names[NB_CENTRALITIES*MAX_VECTORS];
+    if (k > g->n){
+        k = g->n;
+    }
+    node_score *highest = malloc(k*sizeof(node_score));
+    // computing the selected centralities on the same graph
+    for (c=0; c<NB_CENTRALITIES; c++){
+        scores[c] = NULL;
+        if (strcmp(name, "all") != 0 && strcmp(name, centralities[c].name) != 0)
+            continue;
+        printf("\nComputing %s\n", centralities[c].name);
+        if (strcmp(centralities[c].name, "katz") == 0){
+            printf("Katz attenuation factor: %e\n", g->katz_alpha);
+        }
+        it[c] = NB_ITERATIONS;
+        scores[c] = power_method(g, &centralities[c], &it[c], &converged);
+        if (converged){
+            printf("Computing %s: done in %lu iterations.\n", centralities[c].name, it[c]);
+        }
+        else{
+            printf("Computing %s: stopped after %lu iterations without convergence.\n", centralities[c].name, it[c]);
+        }
+        for (v=0; v<centralities[c].nb_vectors; v++){
+            columns[nb_columns] = scores[c] + v*g->n;
+            column_names[nb_columns++] = centralities[c].vector_names[v];
+            // printing the k nodes with the highest scores
+            select_k(scores[c] + v*g->n, g->n, k, highest);
+            printf("\nThe %lu nodes with the highest %s score:\n", k, centralities[c].vector_names[v]);
+            for (i=0; i<k; i++){
+                printf("%lu: Node %lu with score %0.10f\n", i+1, highest[i].node, highest[i].score);
+            }
+        }
+    }
+    if (nb_columns == 0){
+        printf("Unknown centrality %s\n", name);
+    }
+    // writing results in file
+    FILE *f = fopen(argv[2], "w");
+    fprintf(f, "node");
+    for (j=0; j<nb_columns; j++){
+        fprintf(f, " %s", column_names[j]);
+    }
+    fprintf(f, "\n");
+    for (i=0; i<g->n; i++){
+        fprintf(f, "%lu", i);
+        for (j=0; j<nb_columns; j++){
+            fprintf(f, " %0.15f", columns[j][i]);
+        }
+        fprintf(f, "\n");
+    }
+    fclose(f);
+    for (c=0; c<NB_CENTRALITIES; c++){
+        free(scores[c]);
+    }
+    free(highest);
+    free_graph(g);
+    t2=time(NULL);
+    printf("\n- Overall time = %ldh%ldm%lds\n",(t2-t1)/3600,((t2-t1)%3600)/60,((t2-t1)%60));
+    return 0;
+}
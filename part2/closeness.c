@@ -0,0 +1,348 @@
+/*
+The program computes the k nodes with the highest closeness or harmonic centrality without running a full BFS from every node: the nodes are processed by decreasing degree and each BFS is cut as soon as an upper bound on the centrality of its source, derived from the levels already visited, falls below the k-th best score found so far (Bergamini, Borassi, Crescenzi, Marino and Meyerhenke). The sources are processed in parallel, each thread with its own BFS workspace. The graph is considered as undirected, and the closeness of a node u is (r(u)-1)^2/((n-1)*farness(u)) where r(u) is the size of its connected component (normalisation of Bergamini et al. for disconnected graphs: the nodes of small components do not get high scores).
+
+The program expects the following arguments:
+- edgelist.txt that should contain the graph: one edge on each line (two unsigned long (nodes' ID) separated by a space);
+- results.txt for writing the results;
+- optionally, the number k of top nodes (5 by default);
+- optionally, the centrality: closeness (default) or harmonic.
+ 
+To compile:
+"gcc closeness.c -O3 -fopenmp -o closeness".
+
+To execute:
+"./closeness graphs/tuto_graph.txt results/tuto_closeness.txt 5 closeness".
+*/
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h> // to estimate the runing time
+
+#define NB_RESULTS 5
+#define NB_PROGRESS 10 // number of progress reports
+#define NLINKS 100000000 // maximum number of edges for memory allocation, will increase if needed
+
+typedef struct {
+    unsigned long node;
+    double score;
+} centrality;
+
+typedef struct {
+    unsigned long s;
+    unsigned long t;
+} edge;
+
+// edge list structure:
+typedef struct {
+    unsigned long n; // number of nodes
+    unsigned long e; // number of edges
+    edge *edges; // list of edges
+    unsigned long *cd; // cumulative degree cd[0]=0 length=n+1
+    unsigned long *adj; // concatenated lists of neighbors of all nodes
+} adjlist;
+
+// compute the maximum of three unsigned long
+inline unsigned long max3(unsigned long a,unsigned long b,unsigned long c){
+    a=(a>b) ? a : b;
+    return (a>c) ? a : c;
+}
+
+// reading the edgelist from file
+adjlist* readedgelist(char* input){
+    unsigned long e1=NLINKS;
+    FILE *file=fopen(input,"r");
+    adjlist *g=malloc(sizeof(adjlist));
+    g->n=0;
+    g->e=0;
+    g->edges=malloc(e1*sizeof(edge));//allocate some RAM to store edges
+    while (fscanf(file,"%lu %lu", &(g->edges[g->e].s), &(g->edges[g->e].t))==2) {
+        g->n=max3(g->n,g->edges[g->e].s,g->edges[g->e].t);
+        if (++(g->e)==e1) {//increase allocated RAM if needed
+            e1+=NLINKS;
+            g->edges=realloc(g->edges,e1*sizeof(edge));
+        }
+    }
+    fclose(file);
+    g->n++;
+    g->edges=realloc(g->edges,g->e*sizeof(edge));
+    return g;
+}
+
+// building the adjacency matrix
+void mkadjlist(adjlist* g){
+    unsigned long i,u,v;
+    unsigned long *d=calloc(g->n,sizeof(unsigned long));
+    for (i=0;i<g->e;i++) {
+        d[g->edges[i].s]++;
+        d[g->edges[i].t]++;
+    }
+    g->cd=malloc((g->n+1)*sizeof(unsigned long));
+    g->cd[0]=0;
+    for (i=1;i<g->n+1;i++) {
+        g->cd[i]=g->cd[i-1]+d[i-1];
+        d[i-1]=0;
+    }
+    g->adj=malloc(2*g->e*sizeof(unsigned long));
+    for (i=0;i<g->e;i++) {
+        u=g->edges[i].s;
+        v=g->edges[i].t;
+        g->adj[ g->cd[u] + d[u]++ ]=v;
+        g->adj[ g->cd[v] + d[v]++ ]=u;
+    }
+    free(d);
+}
+
+// freeing memory
+void free_adjlist(adjlist *g){
+    free(g->edges);
+    free(g->cd);
+    free(g->adj);
+    free(g);
+}
+
+// computing the size and the volume (sum of the degrees) of the connected component of each node
+void components(adjlist *g, unsigned long *size, unsigned long *volume){
+    unsigned long *fifo = malloc(g->n*sizeof(unsigned long));
+    unsigned long *component = malloc(g->n*sizeof(unsigned long));
+    unsigned long s, b, e, i, u, v, vol;
+    for (u=0; u<g->n; u++){
+        component[u] = ULONG_MAX;
+    }
+    for (s=0; s<g->n; s++){
+        if (component[s] == ULONG_MAX){
+            b = 0;
+            e = 0;
+            vol = 0;
+            fifo[e++] = s;
+            component[s] = s;
+            while (b != e){
+                u = fifo[b++];
+                vol += g->cd[u+1] - g->cd[u];
+                for (i=g->cd[u]; i<g->cd[u+1]; i++){
+                    v = g->adj[i];
+                    if (component[v] == ULONG_MAX){
+                        component[v] = s;
+                        fifo[e++] = v;
+                    }
+                }
+            }
+            for (i=0; i<e; i++){
+                size[fifo[i]] = e;
+                volume[fifo[i]] = vol;
+            }
+        }
+    }
+    free(fifo);
+    free(component);
+}
+
+// BFS from s cut as soon as the upper bound on the centrality of s is not larger than threshold
+// returns 1 and the centrality of s if the BFS is complete, 0 if it is cut
+int pruned_bfs(adjlist *g, unsigned long s, unsigned long r, int harmonic, double *threshold, unsigned long *dist, unsigned long *fifo, double *score, unsigned long *scanned){
+    // the FIFO stores the levels one after the other: the current level is fifo[b..end[
+    unsigned long b = 0, e = 0, end, i, u, v, level = 0, next_bound, remaining;
+    // sum of the distances and of their inverses over the visited nodes
+    double farness = 0., harmonic_sum = 0., bound, current_threshold;
+    // normalisation of the closeness in a component of r nodes
+    double factor = (g->n > 1) ? (double)(r - 1)*(r - 1)/(g->n - 1) : 0.;
+    int complete = 1;
+    fifo[e++] = s;
+    dist[s] = 0;
+    *scanned = 0;
+    while (b != e){
+        end = e;
+        for (; b < end; b++){
+            u = fifo[b];
+            *scanned += g->cd[u+1] - g->cd[u];
+            for (i=g->cd[u]; i<g->cd[u+1]; i++){
+                v = g->adj[i];
+                if (dist[v] == ULONG_MAX){
+                    dist[v] = level + 1;
+                    farness += level + 1;
+                    harmonic_sum += 1./(level + 1);
+                    fifo[e++] = v;
+                }
+            }
+        }
+        level++;
+        if (e == r)
+            break;
+        // upper bound on the size of the next level: each node of the new level has at most deg-1 unvisited neighbors
+        next_bound = 0;
+        for (i=end; i<e; i++){
+            next_bound += g->cd[fifo[i]+1] - g->cd[fifo[i]] - 1;
+        }
+        // the nodes of the component not visited yet are at distance level+1 (at most next_bound of them) or more
+        remaining = r - e;
+        if (next_bound > remaining)
+            next_bound = remaining;
+        if (harmonic)
+            bound = harmonic_sum + (double)next_bound/(level + 1) + (double)(remaining - next_bound)/(level + 2);
+        else
+            bound = factor/(farness + (double)(level + 1)*next_bound + (double)(level + 2)*(remaining - next_bound));
+        #pragma omp atomic read
+        current_threshold = *threshold;
+        if (bound <= current_threshold){
+            complete = 0;
+            break;
+        }
+    }
+    // resetting the visited nodes
+    for (i=0; i<e; i++){
+        dist[fifo[i]] = ULONG_MAX;
+    }
+    if (harmonic)
+        *score = harmonic_sum;
+    else
+        *score = (farness > 0.) ? factor/farness : 0.;
+    return complete;
+}
+
+// adding an element to the min-heap of the k best scores
+void heap_push(centrality *heap, unsigned long *size, unsigned long k, unsigned long node, double score){
+    unsigned long i, child;
+    centrality tmp;
+    if (*size < k){ // sift up
+        i = (*size)++;
+        heap[i].node = node;
+        heap[i].score = score;
+        while (i > 0 && heap[(i-1)/2].score > heap[i].score){
+            tmp = heap[i];
+            heap[i] = heap[(i-1)/2];
+            heap[(i-1)/2] = tmp;
+            i = (i-1)/2;
+        }
+    }
+    else if (score > heap[0].score){ // replacing the minimum and sifting down
+        heap[0].node = node;
+        heap[0].score = score;
+        i = 0;
+        while ((child = 2*i+1) < *size){
+            if (child+1 < *size && heap[child+1].score < heap[child].score)
+                child++;
+            if (heap[child].score >= heap[i].score)
+                break;
+            tmp = heap[i];
+            heap[i] = heap[child];
+            heap[child] = tmp;
+            i = child;
+        }
+    }
+}
+
+// comparing 2 elements by decreasing score
+static int compare_scores(void const *e1, void const *e2){
+    centrality const *element1 = e1;
+    centrality const *element2 = e2;
+    if (element1->score - element2->score > 0)
+        return -1;
+    else if (element1->score - element2->score < 0)
+        return 1;
+    else
+        return 0;
+}
+
+int main(int argc, char** argv){
+    // using the adjlist structure
+    adjlist* g;
+    time_t t1,t2;
+    t1=time(NULL);
+    printf("Reading edgelist from file %s\n",argv[1]);
+    g=readedgelist(argv[1]);
+    printf("Number of nodes: %lu\n",g->n);
+    printf("Number of edges: %lu\n",g->e);
+    printf("Building the adjacency list\n");
+    mkadjlist(g);
+    // initialisation
+    unsigned long k = (argc > 3) ? strtoul(argv[3], NULL, 10) : NB_RESULTS;
+    int harmonic = (argc > 4 && strcmp(argv[4], "harmonic") == 0);
+    const char *name = harmonic ? "harmonic centrality" : "closeness";
+    unsigned long i, heap_size = 0, nb_complete = 0, nb_pruned = 0, nb_done = 0;
+    unsigned long total_scanned = 0, full_scanned = 0;
+    double threshold = -1.; // k-th best score, written in a critical section and read atomically by the BFS
+    if (k > g->n)
+        k = g->n;
+    unsigned long *size = malloc(g->n*sizeof(unsigned long));
+    unsigned long *volume = malloc(g->n*sizeof(unsigned long));
+    centrality *order = malloc(g->n*sizeof(centrality));
+    centrality *heap = malloc(k*sizeof(centrality));
+    components(g, size, volume);
+    // processing the nodes by decreasing degree
+    for (i=0; i<g->n; i++){
+        order[i].node = i;
+        order[i].score = g->cd[i+1] - g->cd[i];
+        full_scanned += volume[i];
+    }
+    qsort(order, g->n, sizeof(centrality), compare_scores);
+    printf("Top %lu %s with pruned BFS:\n", k, name);
+    #pragma omp parallel
+    {
+        // thread-local BFS workspace
+        unsigned long *dist = malloc(g->n*sizeof(unsigned long));
+        unsigned long *fifo = malloc(g->n*sizeof(unsigned long));
+        unsigned long j, s, scanned;
+        double score;
+        int complete;
+        for (j=0; j<g->n; j++){
+            dist[j] = ULONG_MAX;
+        }
+        #pragma omp for schedule(dynamic, 16) reduction(+:total_scanned)
+        for (j=0; j<g->n; j++){
+            s = order[j].node;
+            complete = pruned_bfs(g, s, size[s], harmonic, &threshold, dist, fifo, &score, &scanned);
+            total_scanned += scanned;
+            #pragma omp critical
+            {
+                if (complete){
+                    nb_complete++;
+                    heap_push(heap, &heap_size, k, s, score);
+                    if (heap_size == k){
+                        #pragma omp atomic write
+                        threshold = heap[0].score;
+                    }
+                }
+                else{
+                    nb_pruned++;
+                }
+                nb_done++;
+                if (nb_done % ((g->n + NB_PROGRESS - 1)/NB_PROGRESS) == 0 || nb_done == g->n)
+                    printf("    -- %lu/%lu sources: %lu complete BFS, %lu pruned BFS, k-th best score %0.10f\n", nb_done, g->n, nb_complete, nb_pruned, (heap_size == k) ? heap[0].score : 0.);
+            }
+        }
+        free(dist);
+        free(fifo);
+    }
+    printf("Scanned edges: %lu (%0.2f%% of the %lu edges scanned by a BFS from every node)\n", total_scanned, (full_scanned > 0) ? 100.*total_scanned/full_scanned : 0., full_scanned);
+    qsort(heap, heap_size, sizeof(centrality), compare_scores);
+    // printing results
+    printf("\nThe %lu nodes with the highest %s:\n", heap_size, name);
+    for (i=0; i<heap_size; i++){
+        printf("%lu: ", i+1);
+        printf("Node %lu ", heap[i].node);
+        printf("with score %0.10f\n", heap[i].score);
+    }
+    // writing results in file
+    FILE *f = fopen(argv[2], "w");
+    fprintf(f, "Top %lu %s:\n", k, name);
+    fprintf(f, "\nNumber of complete BFS: %lu\n", nb_complete);
+    fprintf(f, "Number of pruned BFS: %lu\n", nb_pruned);
+    fprintf(f, "Scanned edges: %lu (%0.2f%% of the %lu edges scanned by a BFS from every node)\n", total_scanned, (full_scanned > 0) ? 100.*total_scanned/full_scanned : 0., full_scanned);
+    fprintf(f, "\nThe %lu nodes with the highest %s:\n", heap_size, name);
+    for (i=0; i<heap_size; i++){
+        fprintf(f, "%lu: ", i+1);
+        fprintf(f, "Node %lu ", heap[i].node);
+        fprintf(f, "with score %0.10f\n", heap[i].score);
+    }
+    fclose(f);
+    free(size);
+    free(volume);
+    free(order);
+    free(heap);
+    free_adjlist(g);
+    t2=time(NULL);
+    printf("\n- Overall time = %ldh%ldm%lds\n",(t2-t1)/3600,((t2-t1)%3600)/60,((t2-t1)%60));
+    return 0;
+}
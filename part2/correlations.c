@@ -5,25 +5,43 @@ The program expects the following arguments:
 - edgelist.txt that should contain the graph: one edge on each line (two unsigned long (nodes' ID) separated by a space;
 - degrees_out.txt for writing the degree out of each node;
 - degrees_in.txt for writing the degree in of each node;
-- results.txt for writing the results of the PageRank algorithm.
+- results.txt for writing the results of the PageRank algorithm;
+- optionally, several damping factors alpha: PageRank is then computed for all of them at once (the rank vectors are interleaved so that each edge is read once per iteration for all of them, and a vector which has converged drops out), and the results for alpha = 0.15 are written in results_0_15.txt (results being then used as a prefix);
+- optionally, hist (among the damping factors) to write the log-log histograms of the correlations in results_hist.txt.
+The Pearson and Spearman correlations of the PageRank with alpha = 0.15 (or the first damping factor) with the in-degree, the out-degree and the other PageRank vectors are displayed and written in results_summary.txt; the ranks of the Spearman correlation are computed with a parallel sort.
  
 To compile:
-"gcc correlations.c -O3 -o correlations".
+"gcc correlations.c -O3 -fopenmp -lm -o correlations".
 
 To execute:
 "./correlations graphs/tuto_graph.txt results/tuto_degrees_out.txt results/tuto_degrees_in.txt results/tuto_correlations_0_15.txt".
+"./correlations graphs/tuto_graph.txt results/tuto_degrees_out.txt results/tuto_degrees_in.txt results/tuto_correlations 0.1 0.15 0.2 0.5 0.9".
+"./correlations graphs/tuto_graph.txt results/tuto_degrees_out.txt results/tuto_degrees_in.txt results/tuto_correlations 0.1 0.15 0.2 0.5 0.9 hist".
 */
 
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <strings.h>
+#include <math.h>
 #include <time.h>//to estimate the runing time
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#endif
 
 #define ALPHA 0.15
 #define NB_ITERATIONS 200
 #define EPSILON 0.00000001
 #define NLINKS 100000000 //maximum number of edges for memory allocation, will increase if needed
+#define BINS_PER_DECADE 10 //resolution of the log-log histograms
+
+typedef struct {
+    double value;
+    unsigned long node;
+} node_value;
 
 typedef struct {
     unsigned long s;
@@ -36,6 +54,8 @@ typedef struct {
     unsigned long e;//number of edges
     unsigned long *nodes;// list of nodes
     edge *edges;//list of edges
+    unsigned long *cd_in;//cumulative in-degree cd_in[0]=0 length=n+1
+    unsigned long *adj_in;//concatenated lists of in-neighbors of all nodes
 } edgelist;
 
 //compute the maximum of three unsigned long
@@ -65,8 +85,32 @@ edgelist* readedgelist(char* input){
     return g;
 }
 
+//building the in-adjacency list: the sources of the edges pointing to each node, in the order of the edge list
+void mkinadjlist(edgelist* g){
+    unsigned long i, u, v;
+    unsigned long *d = calloc(g->n, sizeof(unsigned long));
+    for (i=0; i<g->e; i++){
+        d[g->edges[i].t]++;
+    }
+    g->cd_in = malloc((g->n+1)*sizeof(unsigned long));
+    g->cd_in[0] = 0;
+    for (i=1; i<g->n+1; i++){
+        g->cd_in[i] = g->cd_in[i-1] + d[i-1];
+        d[i-1] = 0;
+    }
+    g->adj_in = malloc(g->e*sizeof(unsigned long));
+    for (i=0; i<g->e; i++){
+        u = g->edges[i].s;
+        v = g->edges[i].t;
+        g->adj_in[ g->cd_in[v] + d[v]++ ] = u;
+    }
+    free(d);
+}
+
 void free_edgelist(edgelist *g){
     free(g->edges);
+    free(g->cd_in);
+    free(g->adj_in);
     free(g);
 }
 
@@ -98,24 +142,29 @@ void degree_out(edgelist* g, unsigned long *degrees_out, char *output){
     fclose(f);
 }
 
-double* mat_vect_prod(edgelist* g, unsigned long *degrees_out, double *P){
-    unsigned long l, degree, u, v;
-    double *mat_vect_prod = calloc(g->n, sizeof(double));
-    for (l=0; l<g->e; l++){
-        u = g->edges[l].s;
-        v = g->edges[l].t;
-        mat_vect_prod[v] += ((double)P[u])/((double)degrees_out[u]);
-    }
-    double dead_ends_additions = 0;
-    for (u=0; u<g->n; u++){
-        if (degrees_out[u] == 0){
-            dead_ends_additions += ((double)P[u])/((double)g->n);
-        }
+// pulling the contributions of the in-neighbors of each node for the k damping factors at once: the vectors are interleaved, contrib[u*k+j] = P[u*k+j]/degrees_out[u]
+// P_next[v*k+j] = (1-alphas[j]) * (M.P + dangling[j]) + alphas[j] * I, the norm 1 of each vector is stored in norm_1
+void mat_vect_prod(edgelist* g, double *contrib, double *dangling, double *P_next, double *alphas, unsigned long k, double *s, double *norm_1){
+    unsigned long u, v, j;
+    double *c;
+    for (j=0; j<k; j++){
+        norm_1[j] = 0.;
     }
     for (v=0; v<g->n; v++){
-        mat_vect_prod[v] += dead_ends_additions;
+        for (j=0; j<k; j++){
+            s[j] = 0.;
+        }
+        for (u=g->cd_in[v]; u<g->cd_in[v+1]; u++){
+            c = contrib + g->adj_in[u]*k;
+            for (j=0; j<k; j++){
+                s[j] += c[j];
+            }
+        }
+        for (j=0; j<k; j++){
+            P_next[v*k+j] = (1-alphas[j]) * (s[j] + dangling[j]) + alphas[j] * (1./g->n);
+            norm_1[j] += P_next[v*k+j];
+        }
     }
-    return mat_vect_prod;
 }
 
 double absolute(double element){
@@ -129,46 +178,258 @@ double absolute(double element){
     return abs_element;
 }
 
-double* power_iteration(edgelist* g, unsigned long *degrees_out, unsigned long *t){
-    unsigned long i, it;
-    double norm_1, cvg;
-    double *I = malloc(g->n*sizeof(double));
-    double *P = malloc(g->n*sizeof(double));
-    double *P_prev = malloc(g->n*sizeof(double));
+// removing the vectors which are not kept from the k interleaved vectors X (in place), returns the new number of vectors
+unsigned long compact(double *X, unsigned long n, unsigned long k, unsigned char *kept){
+    unsigned long v, j, l = 0;
+    for (v=0; v<n; v++){
+        for (j=0; j<k; j++){
+            if (kept[j]){
+                X[l++] = X[v*k+j];
+            }
+        }
+    }
+    return l / n;
+}
+
+// power iteration for the k damping factors alphas[0..k-1] at once: the k rank vectors are interleaved, so that each in-edge is read once per iteration for all of them
+// a vector which has converged is copied to its own array and removed from the interleaved vectors; t[j] is the number of iterations for alphas[j]
+double** power_iteration(edgelist* g, unsigned long *degrees_out, double *alphas, unsigned long k, unsigned long *t){
+    unsigned long i, j, it, nb_iterations = t[0], nb_active = k, nb_kept;
+    double **results = malloc(k*sizeof(double*));
+    // two buffers swapped at each iteration and the contribution of each node to its out-neighbors, for the vectors still iterated
+    double *P = malloc(g->n*k*sizeof(double));
+    double *P_next = malloc(g->n*k*sizeof(double));
+    double *contrib = malloc(g->n*k*sizeof(double));
+    double *tmp;
+    // damping factor, index in alphas, dead ends' mass, norm 1, convergence and sum of the contributions of each vector still iterated
+    double *active_alphas = malloc(k*sizeof(double));
+    unsigned long *active = malloc(k*sizeof(unsigned long));
+    double *dangling = calloc(k, sizeof(double));
+    double *norm_1 = malloc(k*sizeof(double));
+    double *cvg = malloc(k*sizeof(double));
+    double *s = malloc(k*sizeof(double));
+    unsigned char *kept = malloc(k*sizeof(unsigned char));
+    for (j=0; j<k; j++){
+        active[j] = j;
+        active_alphas[j] = alphas[j];
+    }
     for (i=0; i<g->n; i++){
-        I[i] = 1./g->n;
-        P[i] = 1./g->n;
+        for (j=0; j<k; j++){
+            P[i*k+j] = 1./g->n;
+            if (degrees_out[i] == 0){
+                contrib[i*k+j] = 0.;
+                dangling[j] += P[i*k+j] / g->n;
+            }
+            else{
+                contrib[i*k+j] = P[i*k+j] / degrees_out[i];
+            }
+        }
     }
-    // initializing previous P
-    P_prev = P;
     // t iterations
-    for (it=0; it<*t; it++){
-        // initializing norm 1
-        norm_1 = 0.;
-        // to measure convergence
-        cvg = 0.0;
+    for (it=0; it<nb_iterations && nb_active>0; it++){
         // updating P
-        P = mat_vect_prod(g, degrees_out, P);
+        mat_vect_prod(g, contrib, dangling, P_next, active_alphas, nb_active, s, norm_1);
+        // to measure convergence
+        for (j=0; j<nb_active; j++){
+            cvg[j] = 0.;
+            dangling[j] = 0.;
+        }
+        // normalisation, convergence and contributions for the next iteration in a single pass
         for (i=0; i<g->n; i++){
-            P[i] = (1-ALPHA) * P[i] + ALPHA * I[i];
-            // updating norm 1
-            norm_1 += P[i];
+            for (j=0; j<nb_active; j++){
+                P_next[i*nb_active+j] += (1.-norm_1[j]) / g->n;
+                cvg[j] += absolute(P_next[i*nb_active+j] - P[i*nb_active+j]);
+                if (degrees_out[i] == 0){
+                    dangling[j] += P_next[i*nb_active+j] / g->n;
+                }
+                else{
+                    contrib[i*nb_active+j] = P_next[i*nb_active+j] / degrees_out[i];
+                }
+            }
+        }
+        tmp = P;
+        P = P_next;
+        P_next = tmp;
+        // convergence test: the vectors which have converged drop out
+        nb_kept = 0;
+        for (j=0; j<nb_active; j++){
+            kept[j] = (cvg[j] >= EPSILON);
+            if (kept[j]){
+                nb_kept++;
+                continue;
+            }
+            t[active[j]] = it;
+            results[active[j]] = malloc(g->n*sizeof(double));
+            for (i=0; i<g->n; i++){
+                results[active[j]][i] = P[i*nb_active+j];
+            }
         }
-        // normalisation
+        if (nb_kept < nb_active){
+            compact(P, g->n, nb_active, kept);
+            compact(contrib, g->n, nb_active, kept);
+            nb_kept = 0;
+            for (j=0; j<nb_active; j++){
+                if (kept[j]){
+                    active[nb_kept] = active[j];
+                    active_alphas[nb_kept] = active_alphas[j];
+                    dangling[nb_kept++] = dangling[j];
+                }
+            }
+            nb_active = nb_kept;
+        }
+    }
+    // vectors which have not converged
+    for (j=0; j<nb_active; j++){
+        results[active[j]] = malloc(g->n*sizeof(double));
         for (i=0; i<g->n; i++){
-            P[i] += (1.-norm_1) / g->n;
-            cvg += absolute(P[i] - P_prev[i]);
+            results[active[j]][i] = P[i*nb_active+j];
+        }
+    }
+    free(P);
+    free(P_next);
+    free(contrib);
+    free(active_alphas);
+    free(active);
+    free(dangling);
+    free(norm_1);
+    free(cvg);
+    free(s);
+    free(kept);
+    return results;
+}
+
+// increasing value, then increasing node ID
+static int compare_values(void const *e1, void const *e2){
+    node_value const *a = e1;
+    node_value const *b = e2;
+    if (a->value != b->value)
+        return (a->value > b->value) - (a->value < b->value);
+    return (a->node > b->node) - (a->node < b->node);
+}
+
+// sorting X (n elements) in parallel: each thread sorts a chunk, then the sorted runs are merged two by two, all the merges of a round in parallel
+void parallel_sort(node_value *X, unsigned long n){
+    long nb_chunks = omp_get_max_threads(), c;
+    unsigned long chunk = (n + nb_chunks - 1) / nb_chunks, width;
+    node_value *buffer = malloc(n*sizeof(node_value)), *src = X, *dst = buffer, *tmp;
+    if (chunk == 0)
+        chunk = 1;
+    #pragma omp parallel for schedule(static, 1)
+    for (c=0; c<nb_chunks; c++){
+        if (c*chunk < n){
+            qsort(X+c*chunk, (c+1)*chunk < n ? chunk : n-c*chunk, sizeof(node_value), compare_values);
+        }
+    }
+    for (width=chunk; width<n; width*=2){
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (c=0; c<(long)((n+2*width-1)/(2*width)); c++){
+            unsigned long lo = c*2*width, mid = lo+width, hi = lo+2*width, a, b, l;
+            mid = (mid < n) ? mid : n;
+            hi = (hi < n) ? hi : n;
+            for (a=lo, b=mid, l=lo; l<hi; l++){
+                if (b >= hi || (a < mid && compare_values(src+a, src+b) <= 0))
+                    dst[l] = src[a++];
+                else
+                    dst[l] = src[b++];
+            }
+        }
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    if (src != X){
+        memcpy(X, src, n*sizeof(node_value));
+    }
+    free(buffer);
+}
+
+// ranks (from 1 to n) of the values x[0..n-1], the tied values getting the average of their ranks
+void ranks(double *x, unsigned long n, double *r){
+    unsigned long i, j, l;
+    node_value *X = malloc(n*sizeof(node_value));
+    #pragma omp parallel for
+    for (i=0; i<n; i++){
+        X[i].value = x[i];
+        X[i].node = i;
+    }
+    parallel_sort(X, n);
+    for (i=0; i<n; i=j){
+        for (j=i+1; j<n && X[j].value == X[i].value; j++);
+        for (l=i; l<j; l++){
+            r[X[l].node] = (i + 1 + j) / 2.;
+        }
+    }
+    free(X);
+}
+
+// Pearson correlation coefficient of x and y (n values), computed from the centered values
+double pearson(double *x, double *y, unsigned long n){
+    unsigned long i;
+    double mean_x = 0., mean_y = 0., sxy = 0., sxx = 0., syy = 0.;
+    #pragma omp parallel for reduction(+:mean_x,mean_y)
+    for (i=0; i<n; i++){
+        mean_x += x[i];
+        mean_y += y[i];
+    }
+    mean_x /= n;
+    mean_y /= n;
+    #pragma omp parallel for reduction(+:sxy,sxx,syy)
+    for (i=0; i<n; i++){
+        sxy += (x[i]-mean_x) * (y[i]-mean_y);
+        sxx += (x[i]-mean_x) * (x[i]-mean_x);
+        syy += (y[i]-mean_y) * (y[i]-mean_y);
+    }
+    if (sxx == 0. || syy == 0.)
+        return 0.;
+    return sxy / sqrt(sxx * syy);
+}
+
+// log-log bin of a value: bin 0 for the zeros, then BINS_PER_DECADE bins per decade from the smallest positive value min
+static inline unsigned long log_bin(double value, double min){
+    if (value <= 0.)
+        return 0;
+    return 1 + (unsigned long)floor(BINS_PER_DECADE * (log10(value) - log10(min)) + 1e-9);
+}
+
+// lower bound of a bin of log_bin
+static inline double bin_low(unsigned long bin, double min){
+    return (bin == 0) ? 0. : pow(10., log10(min) + (double)(bin-1) / BINS_PER_DECADE);
+}
+
+// writing the non-empty cells of the log-log histogram of (x, y) in f: lower and upper bounds of x and of y, number of nodes
+void log_histogram(double *x, double *y, unsigned long n, FILE *f){
+    unsigned long i, bx, by, nb_x, nb_y;
+    double min_x = INFINITY, min_y = INFINITY, max_x = 0., max_y = 0.;
+    #pragma omp parallel for reduction(min:min_x,min_y) reduction(max:max_x,max_y)
+    for (i=0; i<n; i++){
+        if (x[i] > 0.){
+            min_x = (x[i] < min_x) ? x[i] : min_x;
+            max_x = (x[i] > max_x) ? x[i] : max_x;
+        }
+        if (y[i] > 0.){
+            min_y = (y[i] < min_y) ? y[i] : min_y;
+            max_y = (y[i] > max_y) ? y[i] : max_y;
         }
-        // convergence test
-        if (cvg < EPSILON){
-            *t = it;
-            return P;
+    }
+    if (max_x == 0.)
+        min_x = 1.;
+    if (max_y == 0.)
+        min_y = 1.;
+    nb_x = log_bin(max_x, min_x) + 1;
+    nb_y = log_bin(max_y, min_y) + 1;
+    unsigned long *count = calloc(nb_x*nb_y, sizeof(unsigned long));
+    #pragma omp parallel for reduction(+:count[:nb_x*nb_y])
+    for (i=0; i<n; i++){
+        count[log_bin(x[i], min_x)*nb_y + log_bin(y[i], min_y)]++;
+    }
+    for (bx=0; bx<nb_x; bx++){
+        for (by=0; by<nb_y; by++){
+            if (count[bx*nb_y+by] > 0){
+                fprintf(f, "%e %e %e %e %lu\n", bin_low(bx, min_x), (bx == 0) ? 0. : bin_low(bx+1, min_x), bin_low(by, min_y), (by == 0) ? 0. : bin_low(by+1, min_y), count[bx*nb_y+by]);
+            }
         }
-        P_prev = P;
     }
-    free(I);
-    free(P_prev);
-    return P;
+    free(count);
 }
 
 int main(int argc, char** argv){
@@ -179,9 +440,31 @@ int main(int argc, char** argv){
     g=readedgelist(argv[1]);
     printf("Number of nodes: %lu\n",g->n);
     printf("Number of edges: %lu\n",g->e);
+    printf("Building the in-adjacency list\n");
+    mkinadjlist(g);
     // initilaisation
-    unsigned long  it = NB_ITERATIONS; // number of page rank iterations
-    unsigned long i; // index
+    unsigned long i, j; // indexes
+    // damping factors: the ones given after the results file (one results file per damping factor), or ALPHA, and "hist" to write the log-log histograms
+    unsigned long k = 0;
+    int hist = 0;
+    double *alphas = malloc((argc > 5 ? argc-5 : 1)*sizeof(double));
+    char **alpha_names = malloc((argc > 5 ? argc-5 : 1)*sizeof(char*));
+    for (i=5; i<(unsigned long)argc; i++){
+        if (strcmp(argv[i], "hist") == 0){
+            hist = 1;
+            continue;
+        }
+        alpha_names[k] = argv[i];
+        alphas[k++] = atof(argv[i]);
+    }
+    int several = (k > 0);
+    if (k == 0){
+        alphas[k++] = ALPHA;
+    }
+    unsigned long *it = malloc(k*sizeof(unsigned long)); // number of page rank iterations
+    for (j=0; j<k; j++){
+        it[j] = NB_ITERATIONS;
+    }
     // nodes' degrees out
     unsigned long *degrees_out = calloc(g->n, sizeof(unsigned long));
     degree_out(g, degrees_out, argv[2]);
@@ -191,16 +474,104 @@ int main(int argc, char** argv){
     degree_in(g, degrees_in, argv[3]);
     printf("Computing the degree in of each node: done.\n");
     // PageRank
-    double *P = power_iteration(g, degrees_out, &it); // page rank
+    double **P = power_iteration(g, degrees_out, alphas, k, it); // page rank
     printf("Computing PageRank: done.\n");
-    printf("Number of iterations necessary to reach convergence: %lu\n", it);
-    // writing results in file
-    FILE *f = fopen(argv[4], "w");
-    fprintf(f, "PageRank results with alpha = %f:\n", ALPHA);
-    for (i=0; i<g->n; i++){
-        fprintf(f, "%lu %0.15f\n", i, P[i]);
+    for (j=0; j<k; j++){
+        printf("Number of iterations necessary to reach convergence with alpha = %f: %lu\n", alphas[j], it[j]);
     }
-    fclose(f);
+    // writing results in file(s): results.txt, or results_0_15.txt for alpha = 0.15
+    size_t length = strlen("_summary");
+    for (j=0; j<k && several; j++){
+        if (strlen(alpha_names[j]) > length){
+            length = strlen(alpha_names[j]);
+        }
+    }
+    char *output = malloc(strlen(argv[4]) + length + 6);
+    for (j=0; j<k; j++){
+        if (several){
+            sprintf(output, "%s_%s.txt", argv[4], alpha_names[j]);
+            for (i=strlen(argv[4])+1; i<strlen(argv[4])+1+strlen(alpha_names[j]); i++){
+                if (output[i] == '.'){
+                    output[i] = '_';
+                }
+            }
+        }
+        else{
+            strcpy(output, argv[4]);
+        }
+        printf("Writing in file %s\n", output);
+        FILE *f = fopen(output, "w");
+        fprintf(f, "PageRank results with alpha = %f:\n", alphas[j]);
+        for (i=0; i<g->n; i++){
+            fprintf(f, "%lu %0.15f\n", i, P[j][i]);
+        }
+        fclose(f);
+    }
+    // correlations of the PageRank with alpha = 0.15 (or the first damping factor) with the degrees and the other PageRank vectors
+    unsigned long r = 0;
+    for (j=0; j<k; j++){
+        if (alphas[j] == ALPHA){
+            r = j;
+        }
+    }
+    // results_summary.txt and results_hist.txt, or results without its extension followed by _summary.txt and _hist.txt
+    strcpy(output, argv[4]);
+    if (!several && strlen(output) > 4 && strcmp(output+strlen(output)-4, ".txt") == 0){
+        output[strlen(output)-4] = '\0';
+    }
+    length = strlen(output);
+    strcat(output, "_summary.txt");
+    printf("Writing the correlations in file %s\n", output);
+    FILE *f_summary = fopen(output, "w");
+    FILE *f_hist = NULL;
+    if (hist){
+        strcpy(output+length, "_hist.txt");
+        printf("Writing the log-log histograms in file %s\n", output);
+        f_hist = fopen(output, "w");
+    }
+    double *rank_x = malloc(g->n*sizeof(double));
+    double *y = malloc(g->n*sizeof(double));
+    double *rank_y = malloc(g->n*sizeof(double));
+    char label[64];
+    ranks(P[r], g->n, rank_x);
+    printf("\nCorrelations with the PageRank with alpha = %f:\n", alphas[r]);
+    fprintf(f_summary, "Correlations with the PageRank with alpha = %f:\n", alphas[r]);
+    for (j=0; j<k+2; j++){
+        if (j == r+2)
+            continue;
+        if (j < 2){
+            for (i=0; i<g->n; i++){
+                y[i] = (j == 0) ? degrees_in[i] : degrees_out[i];
+            }
+            strcpy(label, (j == 0) ? "in-degree" : "out-degree");
+        }
+        else{
+            memcpy(y, P[j-2], g->n*sizeof(double));
+            sprintf(label, "PageRank with alpha = %f", alphas[j-2]);
+        }
+        ranks(y, g->n, rank_y);
+        double pearson_xy = pearson(P[r], y, g->n), spearman_xy = pearson(rank_x, rank_y, g->n);
+        printf("%s: Pearson = %f, Spearman = %f\n", label, pearson_xy, spearman_xy);
+        fprintf(f_summary, "%s: Pearson = %f, Spearman = %f\n", label, pearson_xy, spearman_xy);
+        if (hist){
+            fprintf(f_hist, "%sLog-log histogram of the %s against the PageRank with alpha = %f (bounds of PageRank, bounds of %s, number of nodes):\n", (j == 0) ? "" : "\n", label, alphas[r], label);
+            log_histogram(P[r], y, g->n, f_hist);
+        }
+    }
+    fclose(f_summary);
+    if (hist){
+        fclose(f_hist);
+    }
+    free(rank_x);
+    free(y);
+    free(rank_y);
+    for (j=0; j<k; j++){
+        free(P[j]);
+    }
+    free(output);
+    free(alphas);
+    free(alpha_names);
+    free(it);
     free(degrees_out);
     free(degrees_in);
     free(P);
@@ -1,48 +1,115 @@
 /*
-The program is the implementation of PageRank using the power iteration method.
+The program is the implementation of PageRank using the power iteration method. The iterations are run in parallel: each thread updates a range of nodes balanced by number of in-edges, and its part of the in-adjacency list and of the rank vectors is first touched by the thread (hence allocated on its NUMA node). The time and the throughput (edges/s) of each iteration are displayed.
 
 The program expects the following arguments:
 - edgelist.txt that should contain the graph: one edge on each line (two unsigned long (nodes' ID) separated by a space);
 - page_names.txt that should contain a mapping between a node ID and a name;
 - degrees_out.txt for writing the degree out of each node;
-- results.txt for writing the results of the PageRank algorithm.
+- results.txt for writing the results of the PageRank algorithm;
+- optionally, the algorithm: power (power iteration, default), gauss-seidel (in-place updates), push (residual push with a worklist), float (power iteration in float32), blocking (power iteration with propagation blocking, default when the rank vector does not fit in the last level cache), warm (warm start from the ranks of a previous run), extrapolation (power iteration with a quadratic extrapolation every QE_PERIOD iterations, kept only when it lowers the residual), adaptive (the nodes whose rank is stable are frozen, then unfrozen to reach the same residual) or ooc (out-of-core); when given, all but warm and ooc are compared with the power iteration;
+- optionally, the number k of pages with the highest and the lowest PageRank to display (0 for the default, 5); it must be given before the options of the algorithm;
+- optionally, with blocking, the maximum number of bins (by default, the blocks of all the threads fit in half of the last level cache);
+- with warm, the binary file of the ranks of the previous run (the new ranks are saved in it) and optionally the edgelist of the previous run: only the difference is then pushed from the nodes whose out-neighbors have changed (warm is not compared with the power iteration);
+- with ooc (out-of-core power iteration, for graphs larger than the memory), optionally the prefix of the shard files (results.txt by default) and the number of shards (by default, shards of SHARD_SIZE bytes):
+  the edges are written into shards by interval of destinations and streamed from the disk at each iteration, only the contributions of the sources and the ranks of the current interval being in memory.
+The pages are selected with heaps of size k, and their names are found with an index of the page names file (saved in page_names.txt.idx and rebuilt when the file changes).
  
 To compile:
-"gcc page_rank.c -O3 -o page_rank".
+"gcc page_rank.c -O3 -fopenmp -o page_rank".
+"gcc page_rank.c -O3 -fopenmp -mavx2 -o page_rank" to vectorise the float32 kernel with AVX2.
+"gcc page_rank.c -O3 -fopenmp -DALPHA=0.1 -o page_rank" for a teleportation probability of 0.1 (damping factor 0.9) instead of 0.15.
 
 To execute:
 "./page_rank graphs/tuto_graph.txt graphs/tuto_names.txt results/tuto_degrees_out.txt results/tuto_pagerank.txt".
+"./page_rank graphs/tuto_graph.txt graphs/tuto_names.txt results/tuto_degrees_out.txt results/tuto_pagerank_push.txt push".
+"./page_rank graphs/tuto_graph.txt graphs/tuto_names.txt results/tuto_degrees_out.txt results/tuto_pagerank.txt power 10" to display the 10 pages with the highest and the lowest PageRank.
+"./page_rank graphs/tuto_graph.txt graphs/tuto_names.txt results/tuto_degrees_out.txt results/tuto_pagerank_blocking.txt blocking 0 2".
+"./page_rank graphs/tuto_graph.txt graphs/tuto_names.txt results/tuto_degrees_out.txt results/tuto_pagerank.txt warm 0 results/tuto_ranks.bin".
+"./page_rank graphs/tuto_graph.txt graphs/tuto_names.txt results/tuto_degrees_out.txt results/tuto_pagerank.txt ooc 0 /tmp/tuto_shard 2".
 */
 
 
+#define _GNU_SOURCE //for O_DIRECT
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <strings.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <math.h>
 #include <time.h>//to estimate the runing time
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#define omp_get_thread_num() 0
+#endif
 
-#define ALPHA 0.15
+#ifndef ALPHA
+#define ALPHA 0.15 //teleportation probability (1 - damping factor)
+#endif
 #define NB_ITERATIONS 200
 #define EPSILON 0.00000001
+#define EPSILON_FLOAT 0.000001 //tolerance of the float32 kernel, limited by the float32 resolution
 #define NB_RESULTS 5
+#define QE_PERIOD 10 //number of power iterations between two quadratic extrapolations
+#define ADAPTIVE_TOLERANCE 0.00001 //relative change of the rank of a node below which it is stable in adaptive mode
+#define ADAPTIVE_STABLE 3 //number of stable iterations after which a node is frozen in adaptive mode
+#define ADAPTIVE_PERIOD 5 //number of iterations between two compactions of the active nodes in adaptive mode
 #define NAME_LENGTH 230
+#define LLC_SIZE 8388608 //size of the last level cache (in bytes) if it cannot be read from the system
 #define NLINKS 100000000 //maximum number of edges for memory allocation, will increase if needed
+#define SHARD_SIZE 268435456 //default size of a shard (in bytes) in out-of-core mode
+#define READ_SIZE 16777216 //size of the reads of the shards (multiple of the block size and of sizeof(edge))
+#define BLOCK_SIZE 4096 //alignment of the read buffer
 
 typedef struct {
     unsigned long node;
     double score;
 } page_rank;
 
+typedef struct {
+    unsigned long node;
+    unsigned long offset;
+} name_entry;
+
+//index of a page names file: the offset of the line of each node, sorted by node
+typedef struct {
+    char *data;//memory-mapped page names file
+    size_t size;
+    unsigned long nb_entries;
+    name_entry *entries;
+} names_index;
+
 typedef struct {
     unsigned long s;
     unsigned long t;
 } edge;
 
+//partial sums of a thread, on its own cache line
+typedef struct {
+    double norm_1;
+    double cvg;
+    double dangling;
+    char padding[40];
+} thread_sums;
+
 //edge list structure:
 typedef struct {
     unsigned long n;//number of nodes
     unsigned long e;//number of edges
     unsigned long *nodes;// list of nodes
     edge *edges;//list of edges
+    unsigned long *cd_in;//cumulative in-degree cd_in[0]=0 length=n+1
+    unsigned long *adj_in;//concatenated lists of in-neighbors of all nodes
+    unsigned long *cd_out;//cumulative out-degree cd_out[0]=0 length=n+1 (push mode only)
+    unsigned long *adj_out;//concatenated lists of out-neighbors of all nodes (push mode only)
 } edgelist;
 
 //compute the maximum of three unsigned long
@@ -58,6 +125,10 @@ edgelist* readedgelist(char* input){
     edgelist *g=malloc(sizeof(edgelist));
     g->n=0;
     g->e=0;
+    g->cd_in=NULL;
+    g->adj_in=NULL;
+    g->cd_out=NULL;
+    g->adj_out=NULL;
     g->edges=malloc(e1*sizeof(edge));//allocate some RAM to store edges
     while (fscanf(file,"%lu %lu", &(g->edges[g->e].s), &(g->edges[g->e].t))==2) {
         g->n=max3(g->n,g->edges[g->e].s,g->edges[g->e].t);
@@ -72,8 +143,55 @@ edgelist* readedgelist(char* input){
     return g;
 }
 
+//building the in-adjacency list: the sources of the edges pointing to each node, in the order of the edge list
+void mkinadjlist(edgelist* g){
+    unsigned long i, u, v;
+    unsigned long *d = calloc(g->n, sizeof(unsigned long));
+    for (i=0; i<g->e; i++){
+        d[g->edges[i].t]++;
+    }
+    g->cd_in = malloc((g->n+1)*sizeof(unsigned long));
+    g->cd_in[0] = 0;
+    for (i=1; i<g->n+1; i++){
+        g->cd_in[i] = g->cd_in[i-1] + d[i-1];
+        d[i-1] = 0;
+    }
+    g->adj_in = malloc(g->e*sizeof(unsigned long));
+    for (i=0; i<g->e; i++){
+        u = g->edges[i].s;
+        v = g->edges[i].t;
+        g->adj_in[ g->cd_in[v] + d[v]++ ] = u;
+    }
+    free(d);
+}
+
+//building the out-adjacency list
+void mkoutadjlist(edgelist* g){
+    unsigned long i, u;
+    unsigned long *d = calloc(g->n, sizeof(unsigned long));
+    for (i=0; i<g->e; i++){
+        d[g->edges[i].s]++;
+    }
+    g->cd_out = malloc((g->n+1)*sizeof(unsigned long));
+    g->cd_out[0] = 0;
+    for (i=1; i<g->n+1; i++){
+        g->cd_out[i] = g->cd_out[i-1] + d[i-1];
+        d[i-1] = 0;
+    }
+    g->adj_out = malloc(g->e*sizeof(unsigned long));
+    for (i=0; i<g->e; i++){
+        u = g->edges[i].s;
+        g->adj_out[ g->cd_out[u] + d[u]++ ] = g->edges[i].t;
+    }
+    free(d);
+}
+
 void free_edgelist(edgelist *g){
     free(g->edges);
+    free(g->cd_in);
+    free(g->adj_in);
+    free(g->cd_out);
+    free(g->adj_out);
     free(g);
 }
 
@@ -91,24 +209,67 @@ void degree_out(edgelist* g, unsigned long *degrees_out, char *output){
     fclose(f);
 }
 
-double* mat_vect_prod(edgelist* g, unsigned long *degrees_out, double *P){
-    unsigned long l, degree, u, v;
-    double *mat_vect_prod = calloc(g->n, sizeof(double));
-    for (l=0; l<g->e; l++){
-        u = g->edges[l].s;
-        v = g->edges[l].t;
-        mat_vect_prod[v] += ((double)P[u])/((double)degrees_out[u]);
-    }
-    double dead_ends_additions = 0;
-    for (u=0; u<g->n; u++){
-        if (degrees_out[u] == 0){
-            dead_ends_additions += ((double)P[u])/((double)g->n);
+double wall_time(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+//splitting the n nodes into nb_parts ranges [bounds[p], bounds[p+1]) of about the same number of edges + nodes, cd being the cumulative degrees (e edges)
+void partition_nodes(unsigned long *cd, unsigned long n, unsigned long e, unsigned long nb_parts, unsigned long *bounds){
+    unsigned long p, lo, hi, mid, target;
+    bounds[0] = 0;
+    for (p=1; p<nb_parts; p++){
+        // first node v with cd[v] + v >= p * (e + n) / nb_parts
+        target = (unsigned long)((double)p * (e + n) / nb_parts);
+        lo = bounds[p-1];
+        hi = n;
+        while (lo < hi){
+            mid = lo + (hi-lo)/2;
+            if (cd[mid] + mid < target)
+                lo = mid+1;
+            else
+                hi = mid;
         }
+        bounds[p] = lo;
     }
-    for (v=0; v<g->n; v++){
-        mat_vect_prod[v] += dead_ends_additions;
+    bounds[nb_parts] = n;
+}
+
+//copying the in-adjacency list so that partition p is first touched (hence allocated on the NUMA node) by thread p, which reads it in the iterations
+//the loop is over the partitions (one per thread, static schedule of chunk 1), so that they are all copied even if the team is smaller than nb_parts
+void place_partitions(edgelist* g, unsigned long *bounds, int nb_parts){
+    int p;
+    unsigned long *cd_in = malloc((g->n+1)*sizeof(unsigned long));
+    unsigned long *adj_in = malloc(g->e*sizeof(unsigned long));
+    #pragma omp parallel for schedule(static, 1) num_threads(nb_parts)
+    for (p=0; p<nb_parts; p++){
+        unsigned long first = bounds[p], last = bounds[p+1];
+        memcpy(cd_in+first, g->cd_in+first, (last-first)*sizeof(unsigned long));
+        memcpy(adj_in+g->cd_in[first], g->adj_in+g->cd_in[first], (g->cd_in[last]-g->cd_in[first])*sizeof(unsigned long));
+    }
+    cd_in[g->n] = g->e;
+    free(g->cd_in);
+    free(g->adj_in);
+    g->cd_in = cd_in;
+    g->adj_in = adj_in;
+}
+
+// pulling the contributions of the in-neighbors of the nodes first to last-1: contrib[u] = P[u]/degrees_out[u] and dangling = sum of P[u]/n over the dead ends
+// P_next = (1-ALPHA) * (M.P + dangling) + ALPHA * I, returns the norm 1 of P_next on these nodes
+double mat_vect_prod(edgelist* g, double *contrib, double dangling, double *P_next, unsigned long first, unsigned long last){
+    unsigned long u, v;
+    double s, norm_1 = 0.;
+    double teleport = ALPHA * (1./g->n);
+    for (v=first; v<last; v++){
+        s = 0.;
+        for (u=g->cd_in[v]; u<g->cd_in[v+1]; u++){
+            s += contrib[g->adj_in[u]];
+        }
+        P_next[v] = (1-ALPHA) * (s + dangling) + teleport;
+        norm_1 += P_next[v];
     }
-    return mat_vect_prod;
+    return norm_1;
 }
 
 double absolute(double element){
@@ -122,149 +283,1843 @@ double absolute(double element){
     return abs_element;
 }
 
-double* power_iteration(edgelist* g, unsigned long *degrees_out, unsigned long *t){
-    unsigned long i, it;
-    double norm_1, cvg;
-    double *I = malloc(g->n*sizeof(double));
+// estimated number of bytes moved by an iteration: the in-adjacency list and the gathered contributions for each edge
+// and, for each node, its cumulative in-degree, its out-degree (or its inverse), its two ranks (the new one written then read) and its contribution
+double iteration_bytes(edgelist* g, size_t real_size, size_t degree_size){
+    return (double)g->e * (sizeof(unsigned long) + real_size) + (double)g->n * (sizeof(unsigned long) + degree_size + 4*real_size);
+}
+
+// the nodes are split into one range per thread, balanced by in-edges; partition p is updated and first touched by thread p
+// (the loops are over the partitions with a static schedule of chunk 1, so that a smaller team still updates all of them)
+// the iterations start from P0 (warm start) if it is not NULL, from the uniform vector otherwise
+double* power_iteration(edgelist* g, unsigned long *degrees_out, double *P0, unsigned long *t, int *converged, unsigned long *nb_edges){
+    int nb_parts = omp_get_max_threads();
+    unsigned long nb_iterations = *t, nb_done = 0;
+    *converged = 0;
+    // two buffers swapped at each iteration and the contribution of each node to its out-neighbors
     double *P = malloc(g->n*sizeof(double));
-    double *P_prev = malloc(g->n*sizeof(double));
+    double *P_next = malloc(g->n*sizeof(double));
+    double *contrib = malloc(g->n*sizeof(double));
+    double time_total = 0.;
+    unsigned long *bounds = malloc((nb_parts+1)*sizeof(unsigned long));
+    thread_sums *sums = malloc(nb_parts*sizeof(thread_sums));
+    partition_nodes(g->cd_in, g->n, g->e, nb_parts, bounds);
+    place_partitions(g, bounds, nb_parts);
+    printf("Number of threads: %d\n", nb_parts);
+    #pragma omp parallel num_threads(nb_parts)
+    {
+        int k, p;
+        unsigned long i, it;
+        double norm_1, cvg, dangling, time_start = 0., time_it;
+        double *P_cur = P, *P_new = P_next, *tmp;
+        // initialisation of the partitions
+        #pragma omp for schedule(static, 1)
+        for (p=0; p<nb_parts; p++){
+            dangling = 0.;
+            for (i=bounds[p]; i<bounds[p+1]; i++){
+                P_cur[i] = (P0 == NULL) ? 1./g->n : P0[i];
+                P_new[i] = 0.;
+                if (degrees_out[i] == 0){
+                    contrib[i] = 0.;
+                    dangling += P_cur[i] / g->n;
+                }
+                else{
+                    contrib[i] = P_cur[i] / degrees_out[i];
+                }
+            }
+            sums[p].dangling = dangling;
+        }
+        dangling = 0.;
+        for (k=0; k<nb_parts; k++){
+            dangling += sums[k].dangling;
+        }
+        // t iterations
+        for (it=0; it<nb_iterations; it++){
+            #pragma omp master
+            time_start = wall_time();
+            // updating P
+            #pragma omp for schedule(static, 1)
+            for (p=0; p<nb_parts; p++){
+                sums[p].norm_1 = mat_vect_prod(g, contrib, dangling, P_new, bounds[p], bounds[p+1]);
+            }
+            norm_1 = 0.;
+            for (k=0; k<nb_parts; k++){
+                norm_1 += sums[k].norm_1;
+            }
+            // normalisation, convergence and contributions for the next iteration in a single pass
+            #pragma omp for schedule(static, 1)
+            for (p=0; p<nb_parts; p++){
+                // to measure convergence
+                cvg = 0.0;
+                dangling = 0.;
+                for (i=bounds[p]; i<bounds[p+1]; i++){
+                    P_new[i] += (1.-norm_1) / g->n;
+                    cvg += absolute(P_new[i] - P_cur[i]);
+                    if (degrees_out[i] == 0){
+                        dangling += P_new[i] / g->n;
+                    }
+                    else{
+                        contrib[i] = P_new[i] / degrees_out[i];
+                    }
+                }
+                sums[p].cvg = cvg;
+                sums[p].dangling = dangling;
+            }
+            cvg = 0.;
+            dangling = 0.;
+            for (k=0; k<nb_parts; k++){
+                cvg += sums[k].cvg;
+                dangling += sums[k].dangling;
+            }
+            tmp = P_cur;
+            P_cur = P_new;
+            P_new = tmp;
+            #pragma omp master
+            {
+                time_it = wall_time() - time_start;
+                time_total += time_it;
+                printf("Iteration %lu: cvg = %e, time = %0.3f s, %0.3e edges/s\n", it, cvg, time_it, g->e/time_it);
+                P = P_cur;
+                P_next = P_new;
+                nb_done = it+1;
+                if (cvg < EPSILON){
+                    *t = it+1;
+                    *converged = 1;
+                }
+            }
+            // convergence test (all the threads have the same cvg)
+            if (cvg < EPSILON){
+                break;
+            }
+        }
+    }
+    printf("Average throughput: %0.3e edges/s\n", time_total > 0. ? nb_done*(double)g->e/time_total : 0.);
+    printf("Average bandwidth: %0.3f GB/s\n", time_total > 0. ? nb_done*iteration_bytes(g, sizeof(double), sizeof(unsigned long))/time_total/1e9 : 0.);
+    *nb_edges = nb_done * g->e;
+    free(P_next);
+    free(contrib);
+    free(bounds);
+    free(sums);
+    return P;
+}
+
+// computing the contributions of P to its out-neighbors (contrib[u] = P[u]/degrees_out[u]), returns the mass of the dead ends divided by n
+double contributions(edgelist* g, unsigned long *degrees_out, double *P, double *contrib){
+    unsigned long i;
+    double dangling = 0.;
+    #pragma omp parallel for reduction(+:dangling)
+    for (i=0; i<g->n; i++){
+        if (degrees_out[i] == 0){
+            contrib[i] = 0.;
+            dangling += P[i] / g->n;
+        }
+        else{
+            contrib[i] = P[i] / degrees_out[i];
+        }
+    }
+    return dangling;
+}
+
+// quadratic extrapolation (Kamvar et al.) from the iterates X0, X1, X2, X3 (oldest first), written in Y:
+// with y_i = X_i - X0, (g1, g2) minimises |g1*y1 + g2*y2 + y3| (least squares), and Y = (g1+g2+1)*X1 + (g2+1)*X2 + X3, normalised by its (signed) sum
+// returns 0 (and leaves Y unchanged) if y1 and y2 are almost colinear or if the sum of Y is not positive and finite
+int quadratic_extrapolation(double *X0, double *X1, double *X2, double *X3, double *Y, unsigned long n){
+    unsigned long i;
+    double a11 = 0., a12 = 0., a22 = 0., b1 = 0., b2 = 0., det, g1, g2, sum = 0.;
+    #pragma omp parallel for reduction(+:a11,a12,a22,b1,b2)
+    for (i=0; i<n; i++){
+        double y1 = X1[i]-X0[i], y2 = X2[i]-X0[i], y3 = X3[i]-X0[i];
+        a11 += y1*y1;
+        a12 += y1*y2;
+        a22 += y2*y2;
+        b1 -= y1*y3;
+        b2 -= y2*y3;
+    }
+    det = a11*a22 - a12*a12;
+    if (det <= 1e-12 * a11 * a22)
+        return 0;
+    g1 = (b1*a22 - b2*a12) / det;
+    g2 = (a11*b2 - a12*b1) / det;
+    #pragma omp parallel for reduction(+:sum)
+    for (i=0; i<n; i++){
+        sum += (g1+g2+1.)*X1[i] + (g2+1.)*X2[i] + X3[i];
+    }
+    if (!(sum > 0.) || !isfinite(sum))
+        return 0;
+    #pragma omp parallel for
+    for (i=0; i<n; i++){
+        Y[i] = ((g1+g2+1.)*X1[i] + (g2+1.)*X2[i] + X3[i]) / sum;
+        // the extrapolation may give small negative ranks
+        if (Y[i] < 0.){
+            Y[i] = 0.;
+        }
+    }
+    return 1;
+}
+
+// one power iteration from P to P_next (contributions of P, product by the matrix and normalisation), returns the L1 distance between P and P_next
+double power_step(edgelist* g, unsigned long *degrees_out, double *contrib, unsigned long *bounds, int nb_parts, double *P, double *P_next){
+    int p;
+    unsigned long i;
+    double norm_1 = 0., cvg = 0., dangling = contributions(g, degrees_out, P, contrib);
+    #pragma omp parallel for schedule(static, 1) num_threads(nb_parts) reduction(+:norm_1)
+    for (p=0; p<nb_parts; p++){
+        norm_1 += mat_vect_prod(g, contrib, dangling, P_next, bounds[p], bounds[p+1]);
+    }
+    #pragma omp parallel for reduction(+:cvg)
+    for (i=0; i<g->n; i++){
+        P_next[i] += (1.-norm_1) / g->n;
+        cvg += absolute(P_next[i] - P[i]);
+    }
+    return cvg;
+}
+
+// power iteration with a quadratic extrapolation every QE_PERIOD iterations, from the last 4 iterates X[0..3] (oldest first), the buffers being swapped and never copied
+// an extrapolation is only kept if its residual (the distance to the next iterate) is smaller than the one of the plain iterate:
+// both are computed (2 iterations, both counted), and the next iterate of the one which is kept is the new current iterate
+double* power_extrapolation(edgelist* g, unsigned long *degrees_out, unsigned long *t, int *converged, unsigned long *nb_edges){
+    int nb_parts = omp_get_max_threads();
+    unsigned long i, j, it = 0, nb_iterations = *t, nb_extrapolations = 0, nb_rejected = 0, since = 0;
+    *converged = 0;
+    int kept;
+    double *X[6], *old[6], *result;
+    double *contrib = malloc(g->n*sizeof(double));
+    double cvg = 0., cvg_extrapolated, cvg_plain, time_it, time_total = 0.;
+    unsigned long *bounds = malloc((nb_parts+1)*sizeof(unsigned long));
+    partition_nodes(g->cd_in, g->n, g->e, nb_parts, bounds);
+    // X[0..3]: the last 4 iterates, X[4] and X[5]: the next iterate and the extrapolation
+    for (j=0; j<6; j++){
+        X[j] = malloc(g->n*sizeof(double));
+    }
+    for (i=0; i<g->n; i++){
+        X[3][i] = 1./g->n;
+    }
+    while (it < nb_iterations){
+        time_it = wall_time();
+        cvg = power_step(g, degrees_out, contrib, bounds, nb_parts, X[3], X[4]);
+        it++;
+        since++;
+        result = X[0];
+        for (j=0; j<4; j++){
+            X[j] = X[j+1];
+        }
+        X[4] = result;
+        time_it = wall_time() - time_it;
+        time_total += time_it;
+        printf("Iteration %lu: cvg = %e, time = %0.3f s\n", it-1, cvg, time_it);
+        if (!isfinite(cvg) || cvg < EPSILON){
+            break;
+        }
+        // extrapolation from the last 4 iterates, if there are 2 iterations left to compare it with the plain iterate
+        if (since >= QE_PERIOD && it >= 3 && it+2 <= nb_iterations && quadratic_extrapolation(X[0], X[1], X[2], X[3], X[5], g->n)){
+            time_it = wall_time();
+            since = 0;
+            // next iterates of the extrapolation (in X[4]) and of the plain iterate (in X[0], the oldest iterate being not needed anymore)
+            cvg_extrapolated = power_step(g, degrees_out, contrib, bounds, nb_parts, X[5], X[4]);
+            cvg_plain = power_step(g, degrees_out, contrib, bounds, nb_parts, X[3], X[0]);
+            it += 2;
+            for (j=0; j<6; j++){
+                old[j] = X[j];
+            }
+            kept = (isfinite(cvg_extrapolated) && cvg_extrapolated < cvg_plain);
+            cvg = kept ? cvg_extrapolated : cvg_plain;
+            X[0] = old[1];
+            X[1] = old[2];
+            if (kept){
+                // the extrapolation and its next iterate become the last 2 iterates (the 2 older ones are replaced before the next extrapolation)
+                nb_extrapolations++;
+                X[2] = old[5];
+                X[3] = old[4];
+                X[4] = old[3];
+                X[5] = old[0];
+            }
+            else{
+                // the plain iterate and its next iterate are the last 2 iterates, as without extrapolation
+                nb_rejected++;
+                X[2] = old[3];
+                X[3] = old[0];
+                X[4] = old[4];
+                X[5] = old[5];
+            }
+            time_it = wall_time() - time_it;
+            time_total += time_it;
+            printf("Iterations %lu-%lu: cvg = %e, time = %0.3f s, extrapolation %s (cvg = %e with it, %e without it)\n", it-2, it-1, cvg, time_it, kept ? "kept" : "rejected", cvg_extrapolated, cvg_plain);
+            if (!isfinite(cvg) || cvg < EPSILON){
+                break;
+            }
+        }
+    }
+    if (!isfinite(cvg)){
+        printf("Non-finite residual after %lu iterations: no convergence\n", it);
+    }
+    else if (cvg >= EPSILON){
+        printf("No convergence after %lu iterations\n", it);
+    }
+    else{
+        *t = it;
+        *converged = 1;
+    }
+    printf("Number of extrapolations: %lu kept, %lu rejected\n", nb_extrapolations, nb_rejected);
+    printf("Average throughput: %0.3e edges/s\n", time_total > 0. ? it*(double)g->e/time_total : 0.);
+    *nb_edges = it * g->e;
+    result = X[3];
+    for (j=0; j<6; j++){
+        if (X[j] != result){
+            free(X[j]);
+        }
+    }
+    free(contrib);
+    free(bounds);
+    return result;
+}
+
+// adaptive power iteration (Kamvar et al.): a node whose rank has changed by less than ADAPTIVE_TOLERANCE times its rank during ADAPTIVE_STABLE iterations is frozen,
+// its rank and its contribution to its out-neighbors are not computed anymore; the frozen nodes are removed from the list of active nodes every ADAPTIVE_PERIOD iterations,
+// so that the later iterations only read the in-edges of the active nodes; when the change of the active nodes is below EPSILON or when all the nodes are frozen,
+// the frozen ranks are not exact: all the nodes are unfrozen and the full iterations go on until the residual over all the nodes is below EPSILON
+double* adaptive_power_iteration(edgelist* g, unsigned long *degrees_out, unsigned long *t, int *converged, unsigned long *nb_edges){
+    unsigned long i, it, nb_iterations = *t, nb_active = g->n, nb_kept, nb_frozen, edges_it;
+    int freezing = 1;
+    *converged = 0;
+    double dangling, cvg, norm_1, time_it, delta;
+    double *P = malloc(g->n*sizeof(double));
+    double *P_next = malloc(g->n*sizeof(double));
+    double *contrib = malloc(g->n*sizeof(double));
+    unsigned long *active = malloc(g->n*sizeof(unsigned long));
+    // number of consecutive iterations with a small change, ADAPTIVE_STABLE for the frozen nodes
+    unsigned char *stable = calloc(g->n, sizeof(unsigned char));
     for (i=0; i<g->n; i++){
-        I[i] = 1./g->n;
         P[i] = 1./g->n;
+        active[i] = i;
     }
-    // initializing previous P
-    P_prev = P;
-    // t iterations
-    for (it=0; it<*t; it++){
-        // initializing norm 1
+    dangling = contributions(g, degrees_out, P, contrib);
+    *nb_edges = 0;
+    for (it=0; it<nb_iterations; it++){
+        time_it = wall_time();
+        // new ranks of the active nodes, from the contributions of the previous iteration
+        edges_it = 0;
+        #pragma omp parallel for schedule(dynamic, 1024) reduction(+:edges_it)
+        for (i=0; i<nb_active; i++){
+            unsigned long v = active[i], u;
+            double s = 0.;
+            if (stable[v] == ADAPTIVE_STABLE)
+                continue;
+            for (u=g->cd_in[v]; u<g->cd_in[v+1]; u++){
+                s += contrib[g->adj_in[u]];
+            }
+            P_next[v] = (1-ALPHA) * (s + dangling) + ALPHA / g->n;
+            edges_it += g->cd_in[v+1] - g->cd_in[v];
+        }
+        // convergence, contributions and freezing of the active nodes
+        cvg = 0.;
+        delta = 0.;
+        nb_frozen = 0;
+        #pragma omp parallel for schedule(dynamic, 1024) reduction(+:cvg,delta,nb_frozen)
+        for (i=0; i<nb_active; i++){
+            unsigned long v = active[i];
+            double change;
+            if (stable[v] == ADAPTIVE_STABLE)
+                continue;
+            change = P_next[v] - P[v];
+            cvg += absolute(change);
+            P[v] = P_next[v];
+            if (degrees_out[v] == 0){
+                delta += change / g->n;
+            }
+            else{
+                contrib[v] = P[v] / degrees_out[v];
+            }
+            if (freezing){
+                stable[v] = (absolute(change) < ADAPTIVE_TOLERANCE * P[v]) ? stable[v]+1 : 0;
+                nb_frozen += (stable[v] == ADAPTIVE_STABLE);
+            }
+        }
+        dangling += delta;
+        *nb_edges += edges_it;
+        // removing the frozen nodes from the active nodes
+        if (freezing && (it+1) % ADAPTIVE_PERIOD == 0){
+            nb_kept = 0;
+            for (i=0; i<nb_active; i++){
+                if (stable[active[i]] < ADAPTIVE_STABLE){
+                    active[nb_kept++] = active[i];
+                }
+            }
+            nb_active = nb_kept;
+        }
+        time_it = wall_time() - time_it;
+        printf("Iteration %lu: cvg = %e, time = %0.3f s, %lu active nodes, %lu frozen now, %lu edges processed\n", it, cvg, time_it, nb_active, nb_frozen, edges_it);
+        if (cvg < EPSILON || nb_active == 0){
+            // without frozen nodes, cvg is the residual over all the nodes
+            if (!freezing){
+                *t = it+1;
+                *converged = 1;
+                break;
+            }
+            // unfreezing all the nodes, from the normalised ranks
+            freezing = 0;
+            norm_1 = 0.;
+            for (i=0; i<g->n; i++){
+                norm_1 += P[i];
+            }
+            nb_frozen = 0;
+            for (i=0; i<g->n; i++){
+                P[i] /= norm_1;
+                nb_frozen += (stable[i] == ADAPTIVE_STABLE);
+                stable[i] = 0;
+                active[i] = i;
+            }
+            nb_active = g->n;
+            dangling = contributions(g, degrees_out, P, contrib);
+            printf("Iteration %lu: unfreezing %lu nodes, full iterations until the residual over all the nodes is below EPSILON\n", it, nb_frozen);
+        }
+    }
+    if (!*converged){
+        printf("No convergence after %lu iterations: the adaptive ranks are approximate\n", nb_iterations);
+    }
+    // normalisation
+    norm_1 = 0.;
+    for (i=0; i<g->n; i++){
+        norm_1 += P[i];
+    }
+    for (i=0; i<g->n; i++){
+        P[i] /= norm_1;
+    }
+    // global residual of the result (one full iteration), to be compared with EPSILON
+    dangling = contributions(g, degrees_out, P, contrib);
+    norm_1 = mat_vect_prod(g, contrib, dangling, P_next, 0, g->n);
+    cvg = 0.;
+    for (i=0; i<g->n; i++){
+        cvg += absolute(P_next[i] + (1.-norm_1) / g->n - P[i]);
+    }
+    printf("Residual of the adaptive ranks over all the nodes: %e\n", cvg);
+    free(P_next);
+    free(contrib);
+    free(active);
+    free(stable);
+    return P;
+}
+
+//compensated (Kahan) summation: adding x to sum, c keeps the lost low-order bits
+static inline void kahan_add(float *sum, float *c, float x){
+    float y = x - *c;
+    float s = *sum + y;
+    *c = (s - *sum) - y;
+    *sum = s;
+}
+
+//sum of the contributions of the in-neighbors adj[0..len-1], gathered 4 at a time with AVX2 for the long lists
+//the float32 contributions are accumulated in double precision: on the hubs, a float32 sum of many contributions keeps a rounding noise above EPSILON_FLOAT
+static inline double sum_contributions_float(float *contrib, unsigned long *adj, unsigned long len){
+    unsigned long i = 0;
+    double s = 0.;
+#ifdef __AVX2__
+    if (len >= 8){
+        __m256d acc = _mm256_setzero_pd();
+        __m128d half;
+        for (; i+4<=len; i+=4){
+            __m256i index = _mm256_loadu_si256((__m256i const*)(adj+i));
+            acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_i64gather_ps(contrib, index, 4)));
+        }
+        half = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+        half = _mm_add_sd(half, _mm_unpackhi_pd(half, half));
+        s = _mm_cvtsd_f64(half);
+    }
+#endif
+    for (; i<len; i++){
+        s += contrib[adj[i]];
+    }
+    return s;
+}
+
+// pulling the contributions of the in-neighbors of the nodes first to last-1 in float32, returns the norm 1 of P_next on these nodes
+double mat_vect_prod_float(edgelist* g, float *contrib, float dangling, float *P_next, unsigned long first, unsigned long last){
+    unsigned long v;
+    float norm_1 = 0.f, c = 0.f;
+    float teleport = ALPHA * (1./g->n);
+    for (v=first; v<last; v++){
+        P_next[v] = (1-ALPHA) * (sum_contributions_float(contrib, g->adj_in+g->cd_in[v], g->cd_in[v+1]-g->cd_in[v]) + dangling) + teleport;
+        kahan_add(&norm_1, &c, P_next[v]);
+    }
+    return norm_1;
+}
+
+// normalisation, convergence and contributions for the next iteration of the nodes first to last-1 in float32, 8 nodes at a time with AVX2
+// the differences (cvg) and the ranks of the dead ends (dangling) are summed with Kahan compensation, lane by lane
+void update_float(float *P_new, float *P_cur, float *contrib, float *inv_degree, float shift, unsigned long first, unsigned long last, double *cvg, double *dangling){
+    unsigned long i = first;
+    float cvg_sum = 0.f, cvg_c = 0.f, dangling_sum = 0.f, dangling_c = 0.f;
+    *cvg = 0.;
+    *dangling = 0.;
+#ifdef __AVX2__
+    int l;
+    float lanes[8];
+    __m256 p, d, y, tmp, inv, mask;
+    __m256 vshift = _mm256_set1_ps(shift), zero = _mm256_setzero_ps(), sign = _mm256_set1_ps(-0.f);
+    __m256 vcvg = zero, vcvg_c = zero, vdangling = zero, vdangling_c = zero;
+    for (; i+8<=last; i+=8){
+        p = _mm256_add_ps(_mm256_loadu_ps(P_new+i), vshift);
+        _mm256_storeu_ps(P_new+i, p);
+        d = _mm256_andnot_ps(sign, _mm256_sub_ps(p, _mm256_loadu_ps(P_cur+i)));
+        y = _mm256_sub_ps(d, vcvg_c);
+        tmp = _mm256_add_ps(vcvg, y);
+        vcvg_c = _mm256_sub_ps(_mm256_sub_ps(tmp, vcvg), y);
+        vcvg = tmp;
+        inv = _mm256_loadu_ps(inv_degree+i);
+        _mm256_storeu_ps(contrib+i, _mm256_mul_ps(p, inv));
+        mask = _mm256_cmp_ps(inv, zero, _CMP_EQ_OQ);
+        y = _mm256_sub_ps(_mm256_and_ps(mask, p), vdangling_c);
+        tmp = _mm256_add_ps(vdangling, y);
+        vdangling_c = _mm256_sub_ps(_mm256_sub_ps(tmp, vdangling), y);
+        vdangling = tmp;
+    }
+    _mm256_storeu_ps(lanes, vcvg);
+    for (l=0; l<8; l++){
+        *cvg += lanes[l];
+    }
+    _mm256_storeu_ps(lanes, vdangling);
+    for (l=0; l<8; l++){
+        *dangling += lanes[l];
+    }
+#endif
+    for (; i<last; i++){
+        P_new[i] += shift;
+        kahan_add(&cvg_sum, &cvg_c, absolute(P_new[i] - P_cur[i]));
+        contrib[i] = P_new[i] * inv_degree[i];
+        if (inv_degree[i] == 0.f){
+            kahan_add(&dangling_sum, &dangling_c, P_new[i]);
+        }
+    }
+    *cvg += cvg_sum;
+    *dangling += dangling_sum;
+}
+
+// power iteration with float32 ranks and contributions and the inverse of the out-degrees computed once
+// the partial sums of the partitions are combined in double precision, and the tolerance is at least EPSILON_FLOAT
+double* power_iteration_float(edgelist* g, unsigned long *degrees_out, unsigned long *t, int *converged, unsigned long *nb_edges){
+    int nb_parts = omp_get_max_threads();
+    unsigned long nb_iterations = *t, nb_done = 0;
+    *converged = 0;
+    double epsilon = (EPSILON > EPSILON_FLOAT) ? EPSILON : EPSILON_FLOAT;
+    float *P = malloc(g->n*sizeof(float));
+    float *P_next = malloc(g->n*sizeof(float));
+    float *contrib = malloc(g->n*sizeof(float));
+    float *inv_degree = malloc(g->n*sizeof(float));
+    double *P_double = malloc(g->n*sizeof(double));
+    double time_total = 0.;
+    unsigned long *bounds = malloc((nb_parts+1)*sizeof(unsigned long));
+    thread_sums *sums = malloc(nb_parts*sizeof(thread_sums));
+    partition_nodes(g->cd_in, g->n, g->e, nb_parts, bounds);
+    place_partitions(g, bounds, nb_parts);
+    printf("Number of threads: %d\n", nb_parts);
+    #pragma omp parallel num_threads(nb_parts)
+    {
+        int k, p;
+        unsigned long i, it;
+        double norm_1, cvg, dangling, time_start = 0., time_it;
+        float *P_cur = P, *P_new = P_next, *tmp;
+        // initialisation of the partitions, partition p being first touched by thread p
+        #pragma omp for schedule(static, 1)
+        for (p=0; p<nb_parts; p++){
+            dangling = 0.;
+            for (i=bounds[p]; i<bounds[p+1]; i++){
+                P_cur[i] = 1./g->n;
+                P_new[i] = 0.f;
+                inv_degree[i] = (degrees_out[i] == 0) ? 0.f : 1.f / degrees_out[i];
+                contrib[i] = P_cur[i] * inv_degree[i];
+                if (degrees_out[i] == 0){
+                    dangling += P_cur[i];
+                }
+            }
+            sums[p].dangling = dangling;
+        }
+        dangling = 0.;
+        for (k=0; k<nb_parts; k++){
+            dangling += sums[k].dangling;
+        }
+        // t iterations
+        for (it=0; it<nb_iterations; it++){
+            #pragma omp master
+            time_start = wall_time();
+            // updating P
+            #pragma omp for schedule(static, 1)
+            for (p=0; p<nb_parts; p++){
+                sums[p].norm_1 = mat_vect_prod_float(g, contrib, dangling / g->n, P_new, bounds[p], bounds[p+1]);
+            }
+            norm_1 = 0.;
+            for (k=0; k<nb_parts; k++){
+                norm_1 += sums[k].norm_1;
+            }
+            // normalisation, convergence and contributions for the next iteration in a single pass
+            #pragma omp for schedule(static, 1)
+            for (p=0; p<nb_parts; p++){
+                update_float(P_new, P_cur, contrib, inv_degree, (1.-norm_1) / g->n, bounds[p], bounds[p+1], &(sums[p].cvg), &(sums[p].dangling));
+            }
+            cvg = 0.;
+            dangling = 0.;
+            for (k=0; k<nb_parts; k++){
+                cvg += sums[k].cvg;
+                dangling += sums[k].dangling;
+            }
+            tmp = P_cur;
+            P_cur = P_new;
+            P_new = tmp;
+            #pragma omp master
+            {
+                time_it = wall_time() - time_start;
+                time_total += time_it;
+                printf("Iteration %lu: cvg = %e, time = %0.3f s, %0.3e edges/s\n", it, cvg, time_it, g->e/time_it);
+                P = P_cur;
+                P_next = P_new;
+                nb_done = it+1;
+                if (cvg < epsilon){
+                    *t = it+1;
+                    *converged = 1;
+                }
+            }
+            // convergence test (all the threads have the same cvg)
+            if (cvg < epsilon){
+                break;
+            }
+        }
+        #pragma omp barrier
+        #pragma omp for schedule(static, 1)
+        for (p=0; p<nb_parts; p++){
+            for (i=bounds[p]; i<bounds[p+1]; i++){
+                P_double[i] = P[i];
+            }
+        }
+    }
+    if (!*converged){
+        printf("No convergence after %lu iterations\n", nb_iterations);
+    }
+    printf("Average throughput: %0.3e edges/s\n", time_total > 0. ? nb_done*(double)g->e/time_total : 0.);
+    printf("Average bandwidth: %0.3f GB/s\n", time_total > 0. ? nb_done*iteration_bytes(g, sizeof(float), sizeof(float))/time_total/1e9 : 0.);
+    *nb_edges = nb_done * g->e;
+    free(P);
+    free(P_next);
+    free(contrib);
+    free(inv_degree);
+    free(bounds);
+    free(sums);
+    return P_double;
+}
+
+// size of the last level cache in bytes
+long llc_size(){
+    long size = -1;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (size <= 0)
+        size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    return (size > 0) ? size : LLC_SIZE;
+}
+
+// power iteration with propagation blocking: the nodes are split into blocks of 2^shift consecutive nodes, each small enough for its ranks to stay in cache
+// at each iteration, the contribution of each edge is first written sequentially in the bin of the block of its destination (binning phase),
+// then the bins are read one after the other and added to the ranks of their block (accumulation phase), so that the random accesses stay in one block
+// the destination of each entry of the bins (relative to its block) is computed once; each thread bins the out-edges of a range of sources into its own part of each bin
+// nb_bins = 0 chooses the number of bins so that the blocks of all the threads fit in half of the last level cache
+double* propagation_blocking(edgelist* g, unsigned long *degrees_out, unsigned long *t, int *converged, unsigned long *nb_edges, unsigned long nb_bins){
+    int nb_parts = omp_get_max_threads(), p;
+    unsigned long i, j, shift = 0, nb_iterations = *t, nb_done = 0, block_size;
+    *converged = 0;
+    double time_total = 0.;
+    // largest block (power of 2) fitting in the cache or smallest one giving at most nb_bins bins
+    if (nb_bins == 0){
+        while (shift < 32 && (2UL << shift) * sizeof(double) * nb_parts <= (unsigned long)llc_size() / 2)
+            shift++;
+    }
+    else{
+        while (shift < 32 && ((g->n + (1UL << shift) - 1) >> shift) > nb_bins)
+            shift++;
+    }
+    block_size = 1UL << shift;
+    nb_bins = (g->n + block_size - 1) >> shift;
+    printf("Propagation blocking with %lu bins of %lu nodes\n", nb_bins, block_size);
+    double *P = malloc(g->n*sizeof(double));
+    double *P_next = malloc(g->n*sizeof(double));
+    double *contrib = malloc(g->n*sizeof(double));
+    double *values = malloc(g->e*sizeof(double)); // contributions binned by destination block
+    unsigned int *destinations = malloc(g->e*sizeof(unsigned int)); // destination of each entry of the bins, relative to its block
+    unsigned long *bounds = malloc((nb_parts+1)*sizeof(unsigned long));
+    unsigned long *source_bounds = malloc((nb_parts+1)*sizeof(unsigned long));
+    // start of the part of the sources of partition p in bin b: offsets[b*nb_parts+p], the bin b ends at offsets[(b+1)*nb_parts]
+    unsigned long *offsets = calloc(nb_bins*nb_parts+1, sizeof(unsigned long));
+    thread_sums *sums = malloc(nb_parts*sizeof(thread_sums));
+    partition_nodes(g->cd_in, g->n, g->e, nb_parts, bounds);
+    partition_nodes(g->cd_out, g->n, g->e, nb_parts, source_bounds);
+    printf("Number of threads: %d\n", nb_parts);
+    // size of the parts of the bins, then their offsets
+    for (j=0; j<(unsigned long)nb_parts; j++){
+        for (i=g->cd_out[source_bounds[j]]; i<g->cd_out[source_bounds[j+1]]; i++){
+            offsets[(g->adj_out[i] >> shift)*nb_parts + j + 1]++;
+        }
+    }
+    for (i=1; i<nb_bins*nb_parts+1; i++){
+        offsets[i] += offsets[i-1];
+    }
+    // the loops are over the partitions (of the sources, of the bins and of the nodes) with a static schedule of chunk 1,
+    // so that partition p is handled by thread p and a smaller team still handles all of them
+    #pragma omp parallel num_threads(nb_parts)
+    {
+        int k;
+        unsigned long b, u, v, l, it;
+        double s, norm_1, cvg, dangling, time_start = 0., time_it;
+        double teleport = ALPHA * (1./g->n);
+        double *P_cur = P, *P_new = P_next, *tmp;
+        // position of the partition in each bin
+        unsigned long *cursor = malloc(nb_bins*sizeof(unsigned long));
+        #pragma omp for schedule(static, 1)
+        for (p=0; p<nb_parts; p++){
+            for (b=0; b<nb_bins; b++){
+                cursor[b] = offsets[b*nb_parts+p];
+            }
+            for (u=source_bounds[p]; u<source_bounds[p+1]; u++){
+                for (l=g->cd_out[u]; l<g->cd_out[u+1]; l++){
+                    v = g->adj_out[l];
+                    destinations[cursor[v >> shift]++] = (unsigned int)(v & (block_size-1));
+                }
+            }
+        }
+        // initialisation of the partitions
+        #pragma omp for schedule(static, 1)
+        for (p=0; p<nb_parts; p++){
+            dangling = 0.;
+            for (u=bounds[p]; u<bounds[p+1]; u++){
+                P_cur[u] = 1./g->n;
+                P_new[u] = 0.;
+                if (degrees_out[u] == 0){
+                    contrib[u] = 0.;
+                    dangling += P_cur[u] / g->n;
+                }
+                else{
+                    contrib[u] = P_cur[u] / degrees_out[u];
+                }
+            }
+            sums[p].dangling = dangling;
+        }
+        dangling = 0.;
+        for (k=0; k<nb_parts; k++){
+            dangling += sums[k].dangling;
+        }
+        // t iterations
+        for (it=0; it<nb_iterations; it++){
+            #pragma omp master
+            time_start = wall_time();
+            // binning phase: sequential writes in the part of the partition of each bin
+            #pragma omp for schedule(static, 1)
+            for (p=0; p<nb_parts; p++){
+                for (b=0; b<nb_bins; b++){
+                    cursor[b] = offsets[b*nb_parts+p];
+                }
+                for (u=source_bounds[p]; u<source_bounds[p+1]; u++){
+                    s = contrib[u];
+                    for (l=g->cd_out[u]; l<g->cd_out[u+1]; l++){
+                        values[cursor[g->adj_out[l] >> shift]++] = s;
+                    }
+                }
+            }
+            // accumulation phase: one block at a time, each partition of the bins (nb_bins/nb_parts consecutive bins) summing its norm
+            #pragma omp for schedule(static, 1)
+            for (p=0; p<nb_parts; p++){
+                norm_1 = 0.;
+                for (b=p*nb_bins/nb_parts; b<(p+1)*nb_bins/nb_parts; b++){
+                    unsigned long start = b << shift, end = (b+1 == nb_bins) ? g->n : (b+1) << shift;
+                    for (v=start; v<end; v++){
+                        P_new[v] = 0.;
+                    }
+                    for (l=offsets[b*nb_parts]; l<offsets[(b+1)*nb_parts]; l++){
+                        P_new[start + destinations[l]] += values[l];
+                    }
+                    for (v=start; v<end; v++){
+                        P_new[v] = (1-ALPHA) * (P_new[v] + dangling) + teleport;
+                        norm_1 += P_new[v];
+                    }
+                }
+                sums[p].norm_1 = norm_1;
+            }
+            norm_1 = 0.;
+            for (k=0; k<nb_parts; k++){
+                norm_1 += sums[k].norm_1;
+            }
+            // normalisation, convergence and contributions for the next iteration in a single pass
+            #pragma omp for schedule(static, 1)
+            for (p=0; p<nb_parts; p++){
+                cvg = 0.;
+                dangling = 0.;
+                for (u=bounds[p]; u<bounds[p+1]; u++){
+                    P_new[u] += (1.-norm_1) / g->n;
+                    cvg += absolute(P_new[u] - P_cur[u]);
+                    if (degrees_out[u] == 0){
+                        dangling += P_new[u] / g->n;
+                    }
+                    else{
+                        contrib[u] = P_new[u] / degrees_out[u];
+                    }
+                }
+                sums[p].cvg = cvg;
+                sums[p].dangling = dangling;
+            }
+            cvg = 0.;
+            dangling = 0.;
+            for (k=0; k<nb_parts; k++){
+                cvg += sums[k].cvg;
+                dangling += sums[k].dangling;
+            }
+            tmp = P_cur;
+            P_cur = P_new;
+            P_new = tmp;
+            #pragma omp master
+            {
+                time_it = wall_time() - time_start;
+                time_total += time_it;
+                printf("Iteration %lu: cvg = %e, time = %0.3f s, %0.3e edges/s\n", it, cvg, time_it, g->e/time_it);
+                P = P_cur;
+                P_next = P_new;
+                nb_done = it+1;
+                if (cvg < EPSILON){
+                    *t = it+1;
+                    *converged = 1;
+                }
+            }
+            // convergence test (all the threads have the same cvg)
+            if (cvg < EPSILON){
+                break;
+            }
+        }
+        free(cursor);
+    }
+    printf("Average throughput: %0.3e edges/s\n", time_total > 0. ? nb_done*(double)g->e/time_total : 0.);
+    *nb_edges = nb_done * g->e;
+    free(P_next);
+    free(contrib);
+    free(values);
+    free(destinations);
+    free(bounds);
+    free(source_bounds);
+    free(offsets);
+    free(sums);
+    return P;
+}
+
+// Gauss-Seidel iterations: the nodes are updated in place, so that each update already uses the new ranks of the nodes updated before it in the same sweep
+double* gauss_seidel(edgelist* g, unsigned long *degrees_out, unsigned long *t, int *converged, unsigned long *nb_edges){
+    unsigned long i, u, it, nb_iterations = *t;
+    *converged = 0;
+    double s, old, norm_1, cvg, dangling = 0.;
+    double teleport = ALPHA * (1./g->n);
+    double *P = malloc(g->n*sizeof(double));
+    double *contrib = malloc(g->n*sizeof(double));
+    for (i=0; i<g->n; i++){
+        P[i] = 1./g->n;
+        if (degrees_out[i] == 0){
+            contrib[i] = 0.;
+            dangling += P[i] / g->n;
+        }
+        else{
+            contrib[i] = P[i] / degrees_out[i];
+        }
+    }
+    *nb_edges = 0;
+    for (it=0; it<nb_iterations; it++){
+        cvg = 0.;
+        for (i=0; i<g->n; i++){
+            s = 0.;
+            for (u=g->cd_in[i]; u<g->cd_in[i+1]; u++){
+                s += contrib[g->adj_in[u]];
+            }
+            old = P[i];
+            P[i] = (1-ALPHA) * (s + dangling) + teleport;
+            cvg += absolute(P[i] - old);
+            if (degrees_out[i] == 0){
+                dangling += (P[i] - old) / g->n;
+            }
+            else{
+                contrib[i] = P[i] / degrees_out[i];
+            }
+        }
+        *nb_edges += g->e;
+        // normalisation: the sum of the ranks is not kept by the in-place updates
         norm_1 = 0.;
-        // to measure convergence
-        cvg = 0.0;
-        // updating P
-        P = mat_vect_prod(g, degrees_out, P);
         for (i=0; i<g->n; i++){
-            P[i] = (1-ALPHA) * P[i] + ALPHA * I[i];
-            // updating norm 1
             norm_1 += P[i];
         }
-        // normalisation
+        dangling = 0.;
         for (i=0; i<g->n; i++){
-            P[i] += (1.-norm_1) / g->n;
-            cvg += absolute(P[i] - P_prev[i]);
+            P[i] /= norm_1;
+            if (degrees_out[i] == 0){
+                dangling += P[i] / g->n;
+            }
+            else{
+                contrib[i] = P[i] / degrees_out[i];
+            }
         }
+        printf("Iteration %lu: cvg = %e\n", it, cvg);
         // convergence test
         if (cvg < EPSILON){
+            *t = it+1;
+            *converged = 1;
+            break;
+        }
+    }
+    free(contrib);
+    return P;
+}
+
+// residual push: P = 0 and the residual R = ALPHA * I; pushing a node u adds R[u] to P[u] and (1-ALPHA) * R[u] / degrees_out[u] to the residual of its out-neighbors
+// the residual of the dead ends is spread uniformly: it is kept in a single value R_uniform added to all the nodes when the worklist is empty
+// at each iteration, the worklist is filled with the nodes whose residual is at least half the average residual (and at least EPSILON/n), then the nodes are pushed until the worklist is empty, a node entering the worklist as soon as its residual crosses the threshold
+// the algorithm stops when the sum of the residuals is below EPSILON
+double* residual_push(edgelist* g, unsigned long *degrees_out, unsigned long *t, int *converged, unsigned long *nb_edges){
+    unsigned long i, u, v, it, head = 0, tail = 0, size = 0, nb_iterations = *t;
+    *converged = 0;
+    double r, push, total, norm_1, R_uniform = 0.;
+    double threshold;
+    double *P = calloc(g->n, sizeof(double));
+    double *R = malloc(g->n*sizeof(double));
+    // circular worklist of the nodes with a large residual
+    unsigned long *worklist = malloc(g->n*sizeof(unsigned long));
+    unsigned char *in_worklist = calloc(g->n, sizeof(unsigned char));
+    for (i=0; i<g->n; i++){
+        R[i] = ALPHA * (1./g->n);
+    }
+    *nb_edges = 0;
+    for (it=0; it<nb_iterations; it++){
+        // spreading the residual of the dead ends and refilling the worklist
+        total = 0.;
+        for (i=0; i<g->n; i++){
+            R[i] += R_uniform;
+            total += R[i];
+        }
+        R_uniform = 0.;
+        printf("Iteration %lu: residual = %e\n", it, total);
+        if (total < EPSILON){
+            // the residual is checked before the round: it rounds have been done
+            *t = it;
+            *converged = 1;
+            break;
+        }
+        threshold = total / g->n / 2.;
+        if (threshold < EPSILON / g->n){
+            threshold = EPSILON / g->n;
+        }
+        for (i=0; i<g->n; i++){
+            if (R[i] >= threshold){
+                worklist[tail] = i;
+                tail = (tail+1 == g->n) ? 0 : tail+1;
+                size++;
+                in_worklist[i] = 1;
+            }
+        }
+        while (size > 0){
+            u = worklist[head];
+            head = (head+1 == g->n) ? 0 : head+1;
+            size--;
+            in_worklist[u] = 0;
+            r = R[u];
+            R[u] = 0.;
+            P[u] += r;
+            if (degrees_out[u] == 0){
+                R_uniform += (1-ALPHA) * r / g->n;
+                continue;
+            }
+            push = (1-ALPHA) * r / degrees_out[u];
+            for (i=g->cd_out[u]; i<g->cd_out[u+1]; i++){
+                v = g->adj_out[i];
+                R[v] += push;
+                if (!in_worklist[v] && R[v] >= threshold){
+                    worklist[tail] = v;
+                    tail = (tail+1 == g->n) ? 0 : tail+1;
+                    size++;
+                    in_worklist[v] = 1;
+                }
+            }
+            *nb_edges += degrees_out[u];
+        }
+    }
+    // normalisation (the remaining residual is not distributed)
+    norm_1 = 0.;
+    for (i=0; i<g->n; i++){
+        norm_1 += P[i];
+    }
+    for (i=0; i<g->n; i++){
+        P[i] /= norm_1;
+    }
+    free(R);
+    free(worklist);
+    free(in_worklist);
+    return P;
+}
+
+// loading a rank vector saved by save_ranks (number of nodes, then the ranks), returns NULL if the file cannot be read
+double* load_ranks(char *input, unsigned long *n){
+    double *P;
+    FILE *f = fopen(input, "rb");
+    if (f == NULL)
+        return NULL;
+    if (fread(n, sizeof(unsigned long), 1, f) != 1){
+        fclose(f);
+        return NULL;
+    }
+    P = malloc(*n*sizeof(double));
+    if (fread(P, sizeof(double), *n, f) != *n){
+        free(P);
+        P = NULL;
+    }
+    fclose(f);
+    return P;
+}
+
+void save_ranks(char *output, double *P, unsigned long n){
+    FILE *f = fopen(output, "wb");
+    fwrite(&n, sizeof(unsigned long), 1, f);
+    fwrite(P, sizeof(double), n, f);
+    fclose(f);
+}
+
+// warm start vector from the ranks P_old of the n_old nodes of a previous run: the new nodes get 1/n, the removed ones are dropped, and the vector is normalised
+double* warm_start(edgelist* g, double *P_old, unsigned long n_old){
+    unsigned long i;
+    double norm_1 = 0.;
+    double *P0 = malloc(g->n*sizeof(double));
+    for (i=0; i<g->n; i++){
+        P0[i] = (i < n_old) ? P_old[i] : 1./g->n;
+        norm_1 += P0[i];
+    }
+    for (i=0; i<g->n; i++){
+        P0[i] /= norm_1;
+    }
+    return P0;
+}
+
+// adding u to the worklist if it is not in it and its residual is large
+static inline void candidates_push(unsigned long *worklist, unsigned char *in_worklist, double *R, double threshold, unsigned long n, unsigned long *tail, unsigned long *size, unsigned long u){
+    if (!in_worklist[u] && absolute(R[u]) >= threshold){
+        worklist[*tail] = u;
+        *tail = (*tail+1 == n) ? 0 : *tail+1;
+        (*size)++;
+        in_worklist[u] = 1;
+    }
+}
+
+// true if u has the same out-neighbors (with multiplicities) in g_old and g, using count (zero on entry and on exit)
+static inline int same_out_neighbors(edgelist* g, edgelist* g_old, unsigned long u, long *count){
+    unsigned long i;
+    int same = 1;
+    if (g_old->cd_out[u+1] - g_old->cd_out[u] != g->cd_out[u+1] - g->cd_out[u])
+        return 0;
+    for (i=g_old->cd_out[u]; i<g_old->cd_out[u+1]; i++){
+        count[g_old->adj_out[i]]++;
+    }
+    for (i=g->cd_out[u]; i<g->cd_out[u+1]; i++){
+        if (count[g->adj_out[i]]-- == 0){
+            same = 0;
+        }
+    }
+    for (i=g_old->cd_out[u]; i<g_old->cd_out[u+1]; i++){
+        count[g_old->adj_out[i]] = 0;
+    }
+    for (i=g->cd_out[u]; i<g->cd_out[u+1]; i++){
+        count[g->adj_out[i]] = 0;
+    }
+    return same;
+}
+
+// incremental PageRank after a change of the graph from g_old (n_old nodes, ranks P_old at convergence) to g, by pushing the difference only
+// the residual of P_old in the new system, R = ALPHA * I + (1-ALPHA) * M.P_old - P_old, is computed locally: it comes from the nodes whose out-neighbors
+// have changed, except for a uniform part due to the dead ends and to the number of nodes, kept in R_uniform; the new nodes start at 0
+// the residuals (which may be negative) are then pushed as in residual_push, with a per round threshold on their absolute value, starting from the changed region only
+// the uniform residual is never pushed: pushing c on every node adds c*n/ALPHA times the solution itself, so it only changes the norm of P, fixed at the end
+// the out-adjacency lists of both graphs must be built
+double* delta_push(edgelist* g, edgelist* g_old, unsigned long *degrees_out, double *P_old, unsigned long n_old, unsigned long *t, int *converged, unsigned long *nb_edges){
+    unsigned long i, u, v, it, head = 0, tail = 0, size = 0, nb_iterations = *t, nb_changed = 0, d_old, d_new;
+    *converged = 0;
+    double r, push, total, norm_1, R_uniform, dangling_old = 0., dangling_new = 0.;
+    double threshold = EPSILON / g->n;
+    double *P = malloc(g->n*sizeof(double));
+    double *R = calloc(g->n, sizeof(double));
+    unsigned long *worklist = malloc(g->n*sizeof(unsigned long));
+    unsigned char *in_worklist = calloc(g->n, sizeof(unsigned char));
+    unsigned char *changed = calloc(n_old, sizeof(unsigned char));
+    long *count = calloc((g->n > n_old) ? g->n : n_old, sizeof(long));
+    for (i=0; i<g->n; i++){
+        P[i] = (i < n_old) ? P_old[i] : 0.;
+    }
+    // mass of the dead ends in both graphs
+    for (u=0; u<n_old; u++){
+        if (g_old->cd_out[u+1] == g_old->cd_out[u]){
+            dangling_old += P_old[u];
+        }
+        if (u < g->n && degrees_out[u] == 0){
+            dangling_new += P_old[u];
+        }
+    }
+    // uniform part of the residual, and the part of the new nodes which had no rank in the previous system
+    R_uniform = ALPHA / g->n + (1-ALPHA) * dangling_new / g->n - ALPHA / n_old - (1-ALPHA) * dangling_old / n_old;
+    for (i=n_old; i<g->n; i++){
+        R[i] = ALPHA / n_old + (1-ALPHA) * dangling_old / n_old;
+    }
+    // local part: the contributions of the nodes whose out-neighbors have changed
+    for (u=0; u<n_old; u++){
+        d_old = g_old->cd_out[u+1] - g_old->cd_out[u];
+        d_new = (u < g->n) ? degrees_out[u] : 0;
+        if (u < g->n && same_out_neighbors(g, g_old, u, count))
+            continue;
+        nb_changed++;
+        for (i=g_old->cd_out[u]; i<g_old->cd_out[u+1]; i++){
+            if (g_old->adj_out[i] < g->n){
+                R[g_old->adj_out[i]] -= (1-ALPHA) * P_old[u] / d_old;
+            }
+        }
+        if (d_new > 0){
+            for (i=g->cd_out[u]; i<g->cd_out[u+1]; i++){
+                R[g->adj_out[i]] += (1-ALPHA) * P_old[u] / d_new;
+            }
+        }
+        changed[u] = 1;
+    }
+    printf("Number of nodes whose out-neighbors have changed: %lu\n", nb_changed);
+    // initial worklist: the new nodes and the old and new out-neighbors of the changed nodes
+    for (u=n_old; u<g->n; u++){
+        candidates_push(worklist, in_worklist, R, threshold, g->n, &tail, &size, u);
+    }
+    for (u=0; u<n_old; u++){
+        if (!changed[u])
+            continue;
+        for (i=g_old->cd_out[u]; i<g_old->cd_out[u+1]; i++){
+            if (g_old->adj_out[i] < g->n){
+                candidates_push(worklist, in_worklist, R, threshold, g->n, &tail, &size, g_old->adj_out[i]);
+            }
+        }
+        if (u >= g->n)
+            continue;
+        for (i=g->cd_out[u]; i<g->cd_out[u+1]; i++){
+            candidates_push(worklist, in_worklist, R, threshold, g->n, &tail, &size, g->adj_out[i]);
+        }
+    }
+    free(changed);
+    free(count);
+    *nb_edges = 0;
+    for (it=0; it<nb_iterations; it++){
+        // refilling the worklist with the nodes above the threshold of the round
+        total = 0.;
+        for (i=0; i<g->n; i++){
+            total += absolute(R[i]);
+        }
+        printf("Iteration %lu: residual = %e, uniform residual = %e\n", it, total, R_uniform * g->n);
+        if (total < EPSILON){
+            // the residual is checked before the round: it rounds have been done
             *t = it;
-            return P;
+            *converged = 1;
+            break;
+        }
+        threshold = total / g->n / 2.;
+        if (threshold < EPSILON / g->n){
+            threshold = EPSILON / g->n;
         }
-        P_prev = P;
+        for (i=0; i<g->n; i++){
+            candidates_push(worklist, in_worklist, R, threshold, g->n, &tail, &size, i);
+        }
+        while (size > 0){
+            u = worklist[head];
+            head = (head+1 == g->n) ? 0 : head+1;
+            size--;
+            in_worklist[u] = 0;
+            r = R[u];
+            R[u] = 0.;
+            P[u] += r;
+            if (degrees_out[u] == 0){
+                R_uniform += (1-ALPHA) * r / g->n;
+                continue;
+            }
+            push = (1-ALPHA) * r / degrees_out[u];
+            for (i=g->cd_out[u]; i<g->cd_out[u+1]; i++){
+                v = g->adj_out[i];
+                R[v] += push;
+                if (!in_worklist[v] && absolute(R[v]) >= threshold){
+                    worklist[tail] = v;
+                    tail = (tail+1 == g->n) ? 0 : tail+1;
+                    size++;
+                    in_worklist[v] = 1;
+                }
+            }
+            *nb_edges += degrees_out[u];
+        }
+    }
+    // normalisation
+    norm_1 = 0.;
+    for (i=0; i<g->n; i++){
+        norm_1 += P[i];
+    }
+    for (i=0; i<g->n; i++){
+        P[i] /= norm_1;
     }
-    free(I);
-    free(P_prev);
+    free(R);
+    free(worklist);
+    free(in_worklist);
     return P;
 }
 
-// comparing 2 elements
-static int compare_scores(void const *e1, void const *e2){
-    page_rank const *element1 = e1;
-    page_rank const *element2 = e2;
-    if (element1->score - element2->score > 0)
-        return -1;
-    else if (element1->score - element2->score < 0)
-        return 1;
-    else
+// growing an array of unsigned long indexed by node to at least n+1 entries (new entries at 0)
+unsigned long* grow_nodes(unsigned long *a, unsigned long *size, unsigned long n){
+    unsigned long old = *size;
+    if (n < *size)
+        return a;
+    while (*size <= n){
+        *size = (*size == 0) ? 1024 : 2 * *size;
+    }
+    a = realloc(a, *size*sizeof(unsigned long));
+    memset(a+old, 0, (*size-old)*sizeof(unsigned long));
+    return a;
+}
+
+// opening a shard for large sequential reads, bypassing the page cache (O_DIRECT) when the file system allows it
+int open_shard(char *name){
+    int fd = -1;
+#ifdef O_DIRECT
+    fd = open(name, O_RDONLY | O_DIRECT);
+#endif
+    if (fd < 0){
+        fd = open(name, O_RDONLY);
+#ifdef POSIX_FADV_SEQUENTIAL
+        if (fd >= 0)
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    }
+    if (fd < 0){
+        printf("Cannot open shard %s: %s\n", name, strerror(errno));
+        exit(1);
+    }
+    return fd;
+}
+
+// reopening a shard through the page cache and going back to the given offset, when O_DIRECT cannot be used for the next read
+int reopen_shard(int fd, char *name, off_t offset){
+    close(fd);
+    fd = open(name, O_RDONLY);
+    if (fd < 0 || lseek(fd, offset, SEEK_SET) != offset){
+        printf("Cannot reopen shard %s: %s\n", name, strerror(errno));
+        exit(1);
+    }
+    return fd;
+}
+
+// out-of-core power iteration: the edges are never loaded in memory
+// the edgelist is read twice: first for the degrees, then to write the edges into nb_shards files (prefix_0, ...) by interval of destinations, balanced by number of edges
+// at each iteration, each shard is streamed with large aligned reads and its edges are accumulated into the ranks of its interval only; the other vectors are the contributions of the sources
+// of the current and of the next iteration (a dead end keeps its rank instead of its contribution, which is never read) and the out-degrees
+// nb_shards = 0 chooses the number of shards so that each shard has about SHARD_SIZE bytes; g only gets the number of nodes and edges; the shards are removed at the end
+double* sharded_page_rank(char *input, char *prefix, unsigned long nb_shards, edgelist *g, unsigned long **degrees, unsigned long *t, int *converged, unsigned long *nb_edges){
+    unsigned long i, s, u, v, it, nb_iterations = *t, size = 0, size_in = 0, nb_done = 0, length, lo, hi, mid;
+    *converged = 0;
+    unsigned long *degrees_out = NULL, *degrees_in = NULL, *bounds;
+    double dangling = 0., dangling_next, cvg, norm_1, *tmp, time_it, time_read, time_total = 0., time_read_total = 0., bytes, bytes_total = 0.;
+    edge e;
+    ssize_t nb_read;
+    char *name = malloc(strlen(prefix)+32);
+    FILE *file = fopen(input, "r");
+    // first pass: number of nodes and edges, degrees
+    g->n = 0;
+    g->e = 0;
+    while (fscanf(file, "%lu %lu", &e.s, &e.t) == 2){
+        degrees_out = grow_nodes(degrees_out, &size, (e.s > e.t) ? e.s : e.t);
+        degrees_in = grow_nodes(degrees_in, &size_in, (e.s > e.t) ? e.s : e.t);
+        degrees_out[e.s]++;
+        degrees_in[e.t]++;
+        g->n = max3(g->n, e.s, e.t);
+        g->e++;
+    }
+    g->n++;
+    degrees_in = grow_nodes(degrees_in, &size_in, g->n);
+    // intervals of destinations with about the same number of in-edges
+    if (nb_shards == 0){
+        nb_shards = (g->e*sizeof(edge) + SHARD_SIZE - 1) / SHARD_SIZE;
+    }
+    nb_shards = (nb_shards == 0) ? 1 : (nb_shards > g->n) ? g->n : nb_shards;
+    for (i=1; i<g->n; i++){
+        degrees_in[i] += degrees_in[i-1];
+    }
+    for (i=g->n; i>0; i--){
+        degrees_in[i] = degrees_in[i-1];
+    }
+    degrees_in[0] = 0;
+    bounds = malloc((nb_shards+1)*sizeof(unsigned long));
+    partition_nodes(degrees_in, g->n, g->e, nb_shards, bounds);
+    free(degrees_in);
+    printf("Number of shards: %lu\n", nb_shards);
+    // second pass: writing the shards
+    FILE **shards = malloc(nb_shards*sizeof(FILE*));
+    for (s=0; s<nb_shards; s++){
+        sprintf(name, "%s_%lu", prefix, s);
+        shards[s] = fopen(name, "wb");
+        if (shards[s] == NULL){
+            printf("Cannot create shard %s: %s\n", name, strerror(errno));
+            exit(1);
+        }
+    }
+    rewind(file);
+    while (fscanf(file, "%lu %lu", &e.s, &e.t) == 2){
+        // shard of the interval of e.t
+        lo = 0;
+        hi = nb_shards-1;
+        while (lo < hi){
+            mid = lo + (hi-lo+1)/2;
+            if (bounds[mid] <= e.t)
+                lo = mid;
+            else
+                hi = mid-1;
+        }
+        fwrite(&e, sizeof(edge), 1, shards[lo]);
+    }
+    fclose(file);
+    for (s=0; s<nb_shards; s++){
+        fclose(shards[s]);
+    }
+    free(shards);
+    // contributions of the sources (ranks of the dead ends), the next ones, the ranks of an interval and the read buffer
+    double *contrib = malloc(g->n*sizeof(double));
+    double *contrib_next = malloc(g->n*sizeof(double));
+    for (s=0, length=0; s<nb_shards; s++){
+        length = (bounds[s+1]-bounds[s] > length) ? bounds[s+1]-bounds[s] : length;
+    }
+    double *slice = malloc(length*sizeof(double));
+    edge *buffer;
+    if (posix_memalign((void**)&buffer, BLOCK_SIZE, READ_SIZE) != 0){
+        buffer = malloc(READ_SIZE);
+    }
+    for (u=0; u<g->n; u++){
+        if (degrees_out[u] == 0){
+            contrib[u] = 1./g->n;
+            dangling += contrib[u] / g->n;
+        }
+        else{
+            contrib[u] = 1./g->n / degrees_out[u];
+        }
+    }
+    for (it=0; it<nb_iterations; it++){
+        time_it = wall_time();
+        time_read = 0.;
+        bytes = 0.;
+        cvg = 0.;
+        norm_1 = 0.;
+        dangling_next = 0.;
+        for (s=0; s<nb_shards; s++){
+            length = bounds[s+1]-bounds[s];
+            memset(slice, 0, length*sizeof(double));
+            sprintf(name, "%s_%lu", prefix, s);
+            int fd = open_shard(name);
+            off_t offset = 0;
+            struct stat st;
+            if (fstat(fd, &st) != 0){
+                printf("Cannot read shard %s: %s\n", name, strerror(errno));
+                exit(1);
+            }
+            if (st.st_size % sizeof(edge) != 0){
+                printf("Invalid shard %s: %lu bytes is not a whole number of edges\n", name, (unsigned long)st.st_size);
+                exit(1);
+            }
+            while (1){
+                double time_start = wall_time();
+                nb_read = read(fd, buffer, READ_SIZE);
+                time_read += wall_time() - time_start;
+                if (nb_read < 0 && errno == EINTR)
+                    continue;
+                if (nb_read < 0 && errno == EINVAL){
+                    // O_DIRECT refused by the file system: reading through the page cache from the same offset
+                    fd = reopen_shard(fd, name, offset);
+                    continue;
+                }
+                if (nb_read < 0){
+                    printf("Cannot read shard %s: %s\n", name, strerror(errno));
+                    exit(1);
+                }
+                if (nb_read == 0)
+                    break;
+                // short read ending inside an edge: the partial edge is read again by the next read, which may be unaligned
+                if (nb_read % sizeof(edge) != 0){
+                    nb_read -= nb_read % sizeof(edge);
+                    fd = reopen_shard(fd, name, offset + nb_read);
+                }
+                offset += nb_read;
+                bytes += nb_read;
+                for (i=0; i<nb_read/sizeof(edge); i++){
+                    slice[buffer[i].t - bounds[s]] += contrib[buffer[i].s];
+                }
+            }
+            close(fd);
+            if (offset != st.st_size){
+                printf("Short read on shard %s: %lu bytes out of %lu\n", name, (unsigned long)offset, (unsigned long)st.st_size);
+                exit(1);
+            }
+            // new ranks of the interval, convergence and contributions for the next iteration
+            #pragma omp parallel for reduction(+:cvg,norm_1,dangling_next)
+            for (v=bounds[s]; v<bounds[s+1]; v++){
+                double p = (1-ALPHA) * (slice[v-bounds[s]] + dangling) + ALPHA / g->n;
+                double p_old = (degrees_out[v] == 0) ? contrib[v] : contrib[v] * degrees_out[v];
+                cvg += absolute(p - p_old);
+                norm_1 += p;
+                if (degrees_out[v] == 0){
+                    contrib_next[v] = p;
+                    dangling_next += p / g->n;
+                }
+                else{
+                    contrib_next[v] = p / degrees_out[v];
+                }
+            }
+        }
+        tmp = contrib;
+        contrib = contrib_next;
+        contrib_next = tmp;
+        // the ranks sum to 1 up to rounding errors: the normalisation is done at the end
+        dangling = dangling_next;
+        time_it = wall_time() - time_it;
+        time_total += time_it;
+        time_read_total += time_read;
+        bytes_total += bytes;
+        nb_done = it+1;
+        printf("Iteration %lu: cvg = %e, time = %0.3f s, %0.3e edges/s, read %0.3f GB at %0.3f GB/s\n", it, cvg, time_it, g->e/time_it, bytes/1e9, time_read > 0. ? bytes/time_read/1e9 : 0.);
+        if (cvg < EPSILON){
+            *t = it+1;
+            *converged = 1;
+            break;
+        }
+    }
+    printf("Average throughput: %0.3e edges/s\n", time_total > 0. ? nb_done*(double)g->e/time_total : 0.);
+    printf("Sustained disk bandwidth: %0.3f GB/s (%0.1f%% of the time spent reading)\n", time_read_total > 0. ? bytes_total/time_read_total/1e9 : 0., time_total > 0. ? 100.*time_read_total/time_total : 0.);
+    *nb_edges = nb_done * g->e;
+    // ranks from the contributions
+    norm_1 = 0.;
+    for (u=0; u<g->n; u++){
+        contrib[u] *= (degrees_out[u] == 0) ? 1. : degrees_out[u];
+        norm_1 += contrib[u];
+    }
+    for (u=0; u<g->n; u++){
+        contrib[u] /= norm_1;
+    }
+    for (s=0; s<nb_shards; s++){
+        sprintf(name, "%s_%lu", prefix, s);
+        unlink(name);
+    }
+    degrees_out = realloc(degrees_out, g->n*sizeof(unsigned long));
+    *degrees = degrees_out;
+    free(name);
+    free(bounds);
+    free(contrib_next);
+    free(slice);
+    free(buffer);
+    return contrib;
+}
+
+// ranking order: decreasing score, then increasing node ID
+static inline int ranks_before(page_rank a, page_rank b){
+    return a.score > b.score || (a.score == b.score && a.node < b.node);
+}
+
+// is a better than b: ranked before it for the highest scores, after it for the lowest scores
+static inline int better(page_rank a, page_rank b, int highest){
+    return highest ? ranks_before(a, b) : ranks_before(b, a);
+}
+
+// moving down the element at position i of a heap of size size whose root is its worst element
+static void sift_down(page_rank *heap, unsigned long size, unsigned long i, int highest){
+    unsigned long child;
+    page_rank tmp;
+    while ((child = 2*i+1) < size){
+        if (child+1 < size && better(heap[child], heap[child+1], highest))
+            child++;
+        if (!better(heap[i], heap[child], highest))
+            break;
+        tmp = heap[i];
+        heap[i] = heap[child];
+        heap[child] = tmp;
+        i = child;
+    }
+}
+
+// finding the k nodes with the highest (or lowest) scores with a heap of size k, in O(n log k)
+// selected is sorted from the best to the worst
+void select_k(double *P, unsigned long n, unsigned long k, int highest, page_rank *selected){
+    unsigned long i, size = 0, j;
+    page_rank x, tmp;
+    for (i=0; i<n; i++){
+        x.node = i;
+        x.score = P[i];
+        if (size < k){
+            // adding x and moving it up
+            j = size++;
+            selected[j] = x;
+            while (j > 0 && better(selected[(j-1)/2], selected[j], highest)){
+                tmp = selected[j];
+                selected[j] = selected[(j-1)/2];
+                selected[(j-1)/2] = tmp;
+                j = (j-1)/2;
+            }
+        }
+        else if (k > 0 && better(x, selected[0], highest)){
+            // replacing the worst selected node
+            selected[0] = x;
+            sift_down(selected, size, 0, highest);
+        }
+    }
+    // sorting: the worst element goes at the end
+    while (size > 1){
+        tmp = selected[0];
+        selected[0] = selected[--size];
+        selected[size] = tmp;
+        sift_down(selected, size, 0, highest);
+    }
+}
+
+// comparing 2 entries of the index of the page names
+static int compare_entries(void const *e1, void const *e2){
+    name_entry const *entry1 = e1;
+    name_entry const *entry2 = e2;
+    if (entry1->node != entry2->node)
+        return (entry1->node < entry2->node) ? -1 : 1;
+    if (entry1->offset != entry2->offset)
+        return (entry1->offset < entry2->offset) ? -1 : 1;
+    return 0;
+}
+
+// memory-mapping the page names file and loading its index from input.idx, or building the index (and saving it) if it is missing or older than the file
+names_index* open_names(char *input){
+    unsigned long nb_entries, node, pos = 0, allocated = NLINKS;
+    long mtime;
+    size_t size;
+    struct stat st;
+    char index_file[4096];
+    FILE *f;
+    names_index *idx = malloc(sizeof(names_index));
+    int fd = open(input, O_RDONLY);
+    idx->data = NULL;
+    idx->size = 0;
+    idx->nb_entries = 0;
+    idx->entries = NULL;
+    if (fd < 0 || fstat(fd, &st) != 0){
+        printf("Cannot read page names from file %s\n", input);
+        if (fd >= 0)
+            close(fd);
+        return idx;
+    }
+    idx->size = st.st_size;
+    if (idx->size > 0){
+        idx->data = mmap(NULL, idx->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (idx->data == MAP_FAILED){
+            idx->data = NULL;
+            idx->size = 0;
+        }
+    }
+    close(fd);
+    if (idx->data == NULL)
+        return idx;
+    // loading the index if it is up to date
+    snprintf(index_file, sizeof(index_file), "%s.idx", input);
+    f = fopen(index_file, "rb");
+    if (f != NULL){
+        if (fread(&size, sizeof(size_t), 1, f) == 1 && fread(&mtime, sizeof(long), 1, f) == 1 && fread(&nb_entries, sizeof(unsigned long), 1, f) == 1
+            && size == idx->size && mtime == (long)st.st_mtime){
+            idx->entries = malloc(nb_entries*sizeof(name_entry));
+            if (fread(idx->entries, sizeof(name_entry), nb_entries, f) == nb_entries){
+                idx->nb_entries = nb_entries;
+                fclose(f);
+                printf("Loading the index of the page names from file %s\n", index_file);
+                return idx;
+            }
+            free(idx->entries);
+            idx->entries = NULL;
+        }
+        fclose(f);
+    }
+    // building the index: one entry for each line starting with a node ID
+    printf("Building the index of the page names\n");
+    idx->entries = malloc(allocated*sizeof(name_entry));
+    while (pos < idx->size){
+        unsigned long start = pos;
+        while (pos < idx->size && (idx->data[pos] == ' ' || idx->data[pos] == '\t'))
+            pos++;
+        if (pos < idx->size && idx->data[pos] >= '0' && idx->data[pos] <= '9'){
+            node = 0;
+            while (pos < idx->size && idx->data[pos] >= '0' && idx->data[pos] <= '9'){
+                node = 10*node + (idx->data[pos++] - '0');
+            }
+            idx->entries[idx->nb_entries].node = node;
+            idx->entries[idx->nb_entries].offset = start;
+            if (++(idx->nb_entries) == allocated){//increase allocated RAM if needed
+                allocated += NLINKS;
+                idx->entries = realloc(idx->entries, allocated*sizeof(name_entry));
+            }
+        }
+        while (pos < idx->size && idx->data[pos] != '\n')
+            pos++;
+        pos++;
+    }
+    idx->entries = realloc(idx->entries, (idx->nb_entries > 0 ? idx->nb_entries : 1)*sizeof(name_entry));
+    qsort(idx->entries, idx->nb_entries, sizeof(name_entry), compare_entries);
+    // saving the index (ignored if the directory is not writable)
+    f = fopen(index_file, "wb");
+    if (f != NULL){
+        mtime = st.st_mtime;
+        fwrite(&(idx->size), sizeof(size_t), 1, f);
+        fwrite(&mtime, sizeof(long), 1, f);
+        fwrite(&(idx->nb_entries), sizeof(unsigned long), 1, f);
+        fwrite(idx->entries, sizeof(name_entry), idx->nb_entries, f);
+        fclose(f);
+    }
+    return idx;
+}
+
+// finding the name of a node by binary search in the index, in O(log n)
+// returns 0 if the node has no name; if a node appears on several lines, its last name is used
+int find_name(names_index *idx, unsigned long node, char *name){
+    unsigned long lo = 0, hi = idx->nb_entries, mid, pos, length = 0;
+    // first entry with a larger node ID
+    while (lo < hi){
+        mid = lo + (hi-lo)/2;
+        if (idx->entries[mid].node <= node)
+            lo = mid+1;
+        else
+            hi = mid;
+    }
+    if (lo == 0 || idx->entries[lo-1].node != node)
         return 0;
+    pos = idx->entries[lo-1].offset;
+    // skipping the node ID and the spaces
+    while (pos < idx->size && (idx->data[pos] == ' ' || idx->data[pos] == '\t'))
+        pos++;
+    while (pos < idx->size && idx->data[pos] >= '0' && idx->data[pos] <= '9')
+        pos++;
+    while (pos < idx->size && (idx->data[pos] == ' ' || idx->data[pos] == '\t'))
+        pos++;
+    while (pos < idx->size && idx->data[pos] != '\n' && idx->data[pos] != '\r' && length < NAME_LENGTH-1){
+        name[length++] = idx->data[pos++];
+    }
+    name[length] = '\0';
+    return length > 0;
+}
+
+void close_names(names_index *idx){
+    if (idx->data != NULL)
+        munmap(idx->data, idx->size);
+    free(idx->entries);
+    free(idx);
 }
 
 int main(int argc, char** argv){
     edgelist* g;
     time_t t1,t2;
     t1=time(NULL);
-    printf("Reading edgelist from file %s\n", argv[1]);
-    g=readedgelist(argv[1]);
-    printf("Number of nodes: %lu\n",g->n);
-    printf("Number of edges: %lu\n",g->e);
     // initialisation
     unsigned long  it = NB_ITERATIONS; // number of page rank iterations
-    unsigned long i, node; // indexes
-    unsigned long highest_node[NB_RESULTS], lowest_node[NB_RESULTS];
-    double highest_score[NB_RESULTS], lowest_score[NB_RESULTS];
-    char page_name[NAME_LENGTH], lowest_page_name[NB_RESULTS][NAME_LENGTH], highest_page_name[NB_RESULTS][NAME_LENGTH];
-    unsigned long *degrees_out = calloc(g->n, sizeof(unsigned long));
-    // initializing lower page name (it might be isolated nodes without names)
-    for (i=0; i<NB_RESULTS; i++){
-        strcpy(lowest_page_name[i], "NO PAGE NAME");
-    }
-    // computing nodes' degrees out
-    degree_out(g, degrees_out, argv[3]);
-    printf("Computing the degree out of each node: done.\n");
-    // using power_iteration algorithm to compute PageRank
-    double *P = power_iteration(g, degrees_out, &it); // page rank
+    unsigned long i; // index
+    unsigned long *degrees_out;
+    // computing PageRank with the power iteration (default), Gauss-Seidel, residual push, float32 power iteration, propagation blocking, warm start or out-of-core algorithm
+    // the layout of the arguments is the same for all the modes: argv[5] the mode, argv[6] the number k of pages to display (0 for NB_RESULTS), then the options of the mode
+    char *mode = (argc > 5) ? argv[5] : "power";
+    char *modes[] = {"power", "gauss-seidel", "push", "float", "blocking", "warm", "extrapolation", "adaptive", "ooc"};
+    unsigned long k = (argc > 6) ? strtoul(argv[6], NULL, 10) : 0;
+    // rejecting a missing argument or an unknown mode before reading the graph
+    for (i=0; i<sizeof(modes)/sizeof(char*) && strcmp(mode, modes[i]) != 0; i++);
+    if (argc < 5 || i == sizeof(modes)/sizeof(char*)){
+        if (argc >= 5){
+            printf("Unknown algorithm %s\n", mode);
+        }
+        printf("Usage: %s edgelist.txt page_names.txt degrees_out.txt results.txt [power|gauss-seidel|push|float|blocking|warm|extrapolation|adaptive|ooc [k [options of the algorithm]]]\n", argv[0]);
+        return 1;
+    }
+    unsigned long nb_edges, it_power = NB_ITERATIONS, nb_edges_power;
+    int converged, converged_power; // set by the methods when the tolerance is reached
+    unsigned long nb_bins = (argc > 7 && strcmp(mode, "blocking") == 0) ? strtoul(argv[7], NULL, 10) : 0;
+    double *P, *P_power, time_mode, time_power, distance = 0.;
+    if (k == 0){
+        k = NB_RESULTS;
+    }
+    // out-of-core: the edgelist is streamed from the file into shards (prefix argv[7], argv[8] shards) and never loaded in memory
+    int ooc = (strcmp(mode, "ooc") == 0);
+    if (ooc){
+        g = calloc(1, sizeof(edgelist));
+    }
+    else{
+        printf("Reading edgelist from file %s\n", argv[1]);
+        g=readedgelist(argv[1]);
+        printf("Number of nodes: %lu\n",g->n);
+        printf("Number of edges: %lu\n",g->e);
+        printf("Building the in-adjacency list\n");
+        mkinadjlist(g);
+        degrees_out = calloc(g->n, sizeof(unsigned long));
+        // computing nodes' degrees out
+        degree_out(g, degrees_out, argv[3]);
+        printf("Computing the degree out of each node: done.\n");
+    }
+    // propagation blocking by default when the rank vector does not fit in the last level cache
+    if (argc <= 5 && g->n*sizeof(double) > (unsigned long)llc_size()){
+        printf("The rank vector does not fit in the last level cache (%ld bytes)\n", llc_size());
+        mode = "blocking";
+    }
+    // warm start from the ranks of a previous run (saved in argv[7]), and incremental update from the previous graph (argv[8])
+    edgelist *g_old = NULL;
+    double *P_old = NULL, *P0 = NULL;
+    unsigned long n_old = 0;
+    if (strcmp(mode, "warm") == 0){
+        P_old = (argc > 7) ? load_ranks(argv[7], &n_old) : NULL;
+        if (P_old == NULL){
+            printf("No previous ranks: starting from the uniform vector\n");
+        }
+        else{
+            printf("Loading previous ranks of %lu nodes from file %s\n", n_old, argv[7]);
+            P0 = warm_start(g, P_old, n_old);
+            if (argc > 8){
+                printf("Reading previous edgelist from file %s\n", argv[8]);
+                g_old = readedgelist(argv[8]);
+                if (g_old->n != n_old){
+                    printf("The previous edgelist has %lu nodes instead of %lu: warm start only\n", g_old->n, n_old);
+                    free_edgelist(g_old);
+                    g_old = NULL;
+                }
+                else{
+                    mkoutadjlist(g_old);
+                }
+            }
+        }
+    }
+    if (strcmp(mode, "push") == 0 || strcmp(mode, "blocking") == 0 || g_old != NULL){
+        printf("Building the out-adjacency list\n");
+        mkoutadjlist(g);
+    }
+    time_mode = wall_time();
+    if (strcmp(mode, "gauss-seidel") == 0){
+        P = gauss_seidel(g, degrees_out, &it, &converged, &nb_edges);
+    }
+    else if (strcmp(mode, "push") == 0){
+        P = residual_push(g, degrees_out, &it, &converged, &nb_edges);
+    }
+    else if (strcmp(mode, "float") == 0){
+        P = power_iteration_float(g, degrees_out, &it, &converged, &nb_edges);
+    }
+    else if (strcmp(mode, "blocking") == 0){
+        P = propagation_blocking(g, degrees_out, &it, &converged, &nb_edges, nb_bins);
+    }
+    else if (strcmp(mode, "warm") == 0 && g_old != NULL){
+        P = delta_push(g, g_old, degrees_out, P_old, n_old, &it, &converged, &nb_edges);
+    }
+    else if (strcmp(mode, "warm") == 0){
+        P = power_iteration(g, degrees_out, P0, &it, &converged, &nb_edges);
+    }
+    else if (strcmp(mode, "adaptive") == 0){
+        P = adaptive_power_iteration(g, degrees_out, &it, &converged, &nb_edges);
+    }
+    else if (strcmp(mode, "extrapolation") == 0){
+        P = power_extrapolation(g, degrees_out, &it, &converged, &nb_edges);
+    }
+    else if (ooc){
+        printf("Streaming edgelist from file %s into shards %s_*\n", argv[1], (argc > 7) ? argv[7] : argv[4]);
+        P = sharded_page_rank(argv[1], (argc > 7) ? argv[7] : argv[4], (argc > 8) ? strtoul(argv[8], NULL, 10) : 0, g, &degrees_out, &it, &converged, &nb_edges);
+        printf("Number of nodes: %lu\n",g->n);
+        printf("Number of edges: %lu\n",g->e);
+        FILE *f = fopen(argv[3], "w");
+        for (i=0; i<g->n; i++){
+            fprintf(f,"%lu %lu\n", i, degrees_out[i]);
+        }
+        fclose(f);
+    }
+    else{
+        mode = "power";
+        P = power_iteration(g, degrees_out, NULL, &it, &converged, &nb_edges);
+    }
+    time_mode = wall_time() - time_mode;
     printf("Computing PageRank: done.\n");
-    // sorting results by score
-    page_rank *P_rank = malloc(g->n*sizeof(page_rank));
-    for (i=0; i<g->n; i++){
-        P_rank[i].node = i;
-        P_rank[i].score = P[i];
-    }
-    qsort(P_rank, g->n, sizeof(page_rank), compare_scores);
-    printf("Sorting score: done.\n");
-    // finding the NB_RESULTS pages with the highest PageRank and the NB_RESULTS pages with the lowest PageRank
-    for (i=0; i<NB_RESULTS; i++){
-        highest_node[i] = P_rank[i].node;
-        highest_score[i] = P_rank[i].score;
-        lowest_node[i] = P_rank[g->n-1-i].node;
-        lowest_score[i] = P_rank[g->n-1-i].score;
+    if (strcmp(mode, "warm") == 0){
+        if (argc > 7){
+            printf("Saving ranks in file %s\n", argv[7]);
+            save_ranks(argv[7], P, g->n);
+        }
+        if (g_old != NULL){
+            free_edgelist(g_old);
+        }
+        free(P_old);
+        free(P0);
+    }
+    printf("Method %s: %lu iterations, %lu edges processed, %0.3f s\n", mode, it, nb_edges, time_mode);
+    // comparing with the power iteration for the same tolerance
+    // (not in warm mode: the incremental run must not pay for a cold run)
+    if (argc > 5 && strcmp(mode, "power") != 0 && strcmp(mode, "warm") != 0 && !ooc){
+        time_power = wall_time();
+        P_power = power_iteration(g, degrees_out, NULL, &it_power, &converged_power, &nb_edges_power);
+        time_power = wall_time() - time_power;
+        for (i=0; i<g->n; i++){
+            distance += absolute(P[i] - P_power[i]);
+        }
+        printf("Method power: %lu iterations, %lu edges processed, %0.3f s\n", it_power, nb_edges_power, time_power);
+        printf("L1 distance between the two results: %e\n", distance);
+        printf("Reduction with respect to the power iteration: %0.1f%% iterations, %0.1f%% edges processed, %0.1f%% time\n", 100.*(1. - (double)it/it_power), 100.*(1. - (double)nb_edges/nb_edges_power), 100.*(1. - time_mode/time_power));
+        free(P_power);
+    }
+    // finding the k pages with the highest PageRank and the k pages with the lowest PageRank
+    if (k > g->n){
+        k = g->n;
     }
+    page_rank *highest = malloc(k*sizeof(page_rank));
+    page_rank *lowest = malloc(k*sizeof(page_rank));
+    select_k(P, g->n, k, 1, highest);
+    select_k(P, g->n, k, 0, lowest);
     printf("Finding highest page ranks and lowest page ranks: done.\n");
-    // reading the name of the pages corresponding to each node ID
-    FILE *file = fopen(argv[2], "r");
-    // finding the name of the NB_RESULTS pages with the highest PageRank and the NB_RESULTS pages with the lowest PageRank
-    while (fscanf(file, "%lu %[^\n]", &(node), page_name)==2) {
-        for (i=0; i<NB_RESULTS; i++){
-            if (node == lowest_node[i]){
-                strcpy(lowest_page_name[i], page_name);
-            }
-            if (node == highest_node[i]){
-                strcpy(highest_page_name[i], page_name);
-            }
+    // reading the name of the pages corresponding to each node ID (it might be isolated nodes without names)
+    names_index *names = open_names(argv[2]);
+    char (*highest_page_name)[NAME_LENGTH] = malloc(k*sizeof(*highest_page_name));
+    char (*lowest_page_name)[NAME_LENGTH] = malloc(k*sizeof(*lowest_page_name));
+    for (i=0; i<k; i++){
+        if (!find_name(names, highest[i].node, highest_page_name[i])){
+            strcpy(highest_page_name[i], "NO PAGE NAME");
+        }
+        if (!find_name(names, lowest[i].node, lowest_page_name[i])){
+            strcpy(lowest_page_name[i], "NO PAGE NAME");
         }
     }
-    fclose(file);
+    close_names(names);
     printf("Reading page names: done.\n");
     // printing results
     printf("\nPageRank results with alpha = %f:\n", ALPHA);
-    printf("\nNumber of iterations necessary to reach convergence: %lu\n", it);
-    printf("\nThe %i pages with the highest PageRank:\n", NB_RESULTS);
-    for (i=0; i<NB_RESULTS; i++){
+    if (converged){
+        printf("\nNumber of iterations necessary to reach convergence: %lu\n", it);
+    }
+    else{
+        printf("\nNo convergence after %d iterations\n", NB_ITERATIONS);
+    }
+    printf("\nThe %lu pages with the highest PageRank:\n", k);
+    for (i=0; i<k; i++){
         printf("%lu: ", i+1);
-        printf("Node %lu ", highest_node[i]);
-        printf("with score %0.10f ", highest_score[i]);
+        printf("Node %lu ", highest[i].node);
+        printf("with score %0.10f ", highest[i].score);
         printf("and name %s\n", highest_page_name[i]);
     }
-    printf("\nThe %i pages with the lowest PageRank:\n", NB_RESULTS);
-    for (i=0; i<NB_RESULTS; i++){
+    printf("\nThe %lu pages with the lowest PageRank:\n", k);
+    for (i=0; i<k; i++){
         printf("%lu: ", i+1);
-        printf("Node %lu ", lowest_node[i]);
-        printf("with score %0.10f ", lowest_score[i]);
+        printf("Node %lu ", lowest[i].node);
+        printf("with score %0.10f ", lowest[i].score);
         printf("and name %s\n", lowest_page_name[i]);
     }
     // writing results in file
     FILE *f = fopen(argv[4], "w");
     fprintf(f, "PageRank results with alpha = %f:\n", ALPHA);
-    fprintf(f, "\nNumber of iterations necessary to reach convergence: %lu\n", it);
-    fprintf(f, "\nThe %i pages with the highest PageRank:\n", NB_RESULTS);
-    for (i=0; i<NB_RESULTS; i++){
+    if (converged){
+        fprintf(f, "\nNumber of iterations necessary to reach convergence: %lu\n", it);
+    }
+    else{
+        fprintf(f, "\nNo convergence after %d iterations\n", NB_ITERATIONS);
+    }
+    fprintf(f, "\nThe %lu pages with the highest PageRank:\n", k);
+    for (i=0; i<k; i++){
         fprintf(f, "%lu: ", i+1);
-        fprintf(f, "Node %lu ", highest_node[i]);
-        fprintf(f, "with score %0.10f ", highest_score[i]);
+        fprintf(f, "Node %lu ", highest[i].node);
+        fprintf(f, "with score %0.10f ", highest[i].score);
         fprintf(f, "and name %s\n", highest_page_name[i]);
     }
-    fprintf(f, "\nThe %i pages with the lowest PageRank:\n", NB_RESULTS);
-    for (i=0; i<NB_RESULTS; i++){
+    fprintf(f, "\nThe %lu pages with the lowest PageRank:\n", k);
+    for (i=0; i<k; i++){
         fprintf(f, "%lu: ", i+1);
-        fprintf(f, "Node %lu ", lowest_node[i]);
-        fprintf(f, "with score %0.10f ", lowest_score[i]);
+        fprintf(f, "Node %lu ", lowest[i].node);
+        fprintf(f, "with score %0.10f ", lowest[i].score);
         fprintf(f, "and name %s\n", lowest_page_name[i]);
     }
     fprintf(f, "\nFull PageRank results:\n");
@@ -274,7 +2129,10 @@ int main(int argc, char** argv){
     fclose(f);
     free(degrees_out);
     free(P);
-    free(P_rank);
+    free(highest);
+    free(lowest);
+    free(highest_page_name);
+    free(lowest_page_name);
     free_edgelist(g);
     t2=time(NULL);
     printf("\n- Overall time = %ldh%ldm%lds\n",(t2-t1)/3600,((t2-t1)%3600)/60,((t2-t1)%60));
@@ -0,0 +1,411 @@
+/*
+The program computes the personalized PageRank of many seed sets: the random surfer teleports, with probability alpha, to a node chosen uniformly at random among the seed set instead of among all the nodes (it also goes back to the seed set from the dead ends). For each seed set, it uses either the forward push algorithm of Andersen, Chung and Lang (the residual of a node u is pushed while it is larger than EPSILON * degree_out(u)) or Monte Carlo random walks (NB_WALKS walks starting from the seed set and stopping with probability alpha at each step). The seed sets are processed in parallel; each thread reuses its own scratch vectors and only resets the nodes touched by the previous seed set, so that the cost of a seed set does not depend on the number of nodes but on the size of the region it explores.
+
+The program expects the following arguments:
+- edgelist.txt that should contain the graph: one edge on each line (two unsigned long (nodes' ID) separated by a space);
+- seeds.txt that should contain the seed sets: one seed set on each line (nodes' ID separated by spaces);
+- results.txt for writing the k nodes with the highest personalized PageRank of each seed set;
+- optionally, the number k of nodes per seed set (5 by default);
+- optionally, the algorithm: push (default) or montecarlo.
+
+To compile:
+"gcc personalized_page_rank.c -O3 -fopenmp -o personalized_page_rank".
+
+To execute:
+"./personalized_page_rank graphs/tuto_graph.txt graphs/tuto_seeds.txt results/tuto_personalized_pagerank.txt 5 push".
+*/
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h> // to estimate the runing time
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#define omp_get_thread_num() 0
+#endif
+
+#define ALPHA 0.15
+#define EPSILON 0.0000001 // push threshold per out-edge
+#define NB_WALKS 100000 // number of random walks per seed set
+#define NB_RESULTS 5
+#define NLINKS 100000000 // maximum number of edges for memory allocation, will increase if needed
+#define NSEEDS 1000000 // maximum number of seeds for memory allocation, will increase if needed
+
+typedef struct {
+    unsigned long node;
+    double score;
+} page_rank;
+
+typedef struct {
+    unsigned long s;
+    unsigned long t;
+} edge;
+
+// edge list structure:
+typedef struct {
+    unsigned long n; // number of nodes
+    unsigned long e; // number of edges
+    edge *edges; // list of edges
+    unsigned long *cd; // cumulative out-degree cd[0]=0 length=n+1
+    unsigned long *adj; // concatenated lists of out-neighbors of all nodes
+} edgelist;
+
+// seed sets: the seeds of set i are seeds[cd[i]] to seeds[cd[i+1]-1]
+typedef struct {
+    unsigned long nb_sets; // number of seed sets
+    unsigned long *cd; // cumulative size of the seed sets
+    unsigned long *seeds; // concatenated seed sets
+} seedsets;
+
+// scratch vectors of a thread, all zero outside of the touched nodes
+typedef struct {
+    double *p; // personalized PageRank (or number of walks ending on each node)
+    double *r; // residual
+    unsigned char *in_queue;
+    unsigned char *touched;
+    unsigned long *queue; // circular queue of the nodes to push
+    unsigned long *list; // list of the touched nodes
+    unsigned long nb_touched;
+    unsigned long long state; // state of the random generator
+} workspace;
+
+// compute the maximum of three unsigned long
+inline unsigned long max3(unsigned long a,unsigned long b,unsigned long c){
+    a=(a>b) ? a : b;
+    return (a>c) ? a : c;
+}
+
+// reading the edgelist from file
+edgelist* readedgelist(char* input){
+    unsigned long e1=NLINKS;
+    FILE *file=fopen(input,"r");
+    edgelist *g=malloc(sizeof(edgelist));
+    g->n=0;
+    g->e=0;
+    g->edges=malloc(e1*sizeof(edge));//allocate some RAM to store edges
+    while (fscanf(file,"%lu %lu", &(g->edges[g->e].s), &(g->edges[g->e].t))==2) {
+        g->n=max3(g->n,g->edges[g->e].s,g->edges[g->e].t);
+        if (++(g->e)==e1) {//increase allocated RAM if needed
+            e1+=NLINKS;
+            g->edges=realloc(g->edges,e1*sizeof(edge));
+        }
+    }
+    fclose(file);
+    g->n++;
+    g->edges=realloc(g->edges,g->e*sizeof(edge));
+    return g;
+}
+
+// building the out-adjacency list
+void mkadjlist(edgelist* g){
+    unsigned long i, u;
+    unsigned long *d = calloc(g->n, sizeof(unsigned long));
+    for (i=0; i<g->e; i++){
+        d[g->edges[i].s]++;
+    }
+    g->cd = malloc((g->n+1)*sizeof(unsigned long));
+    g->cd[0] = 0;
+    for (i=1; i<g->n+1; i++){
+        g->cd[i] = g->cd[i-1] + d[i-1];
+        d[i-1] = 0;
+    }
+    g->adj = malloc(g->e*sizeof(unsigned long));
+    for (i=0; i<g->e; i++){
+        u = g->edges[i].s;
+        g->adj[ g->cd[u] + d[u]++ ] = g->edges[i].t;
+    }
+    free(d);
+    free(g->edges);
+    g->edges = NULL;
+}
+
+void free_edgelist(edgelist *g){
+    free(g->cd);
+    free(g->adj);
+    free(g);
+}
+
+// reading the seed sets from file, one set per line (the nodes which are not in the graph are ignored)
+seedsets* readseeds(char* input, unsigned long n){
+    unsigned long s1 = NSEEDS, s2 = NSEEDS, nb_seeds = 0, node;
+    char *line = NULL, *c, *end;
+    size_t length = 0;
+    FILE *file = fopen(input, "r");
+    seedsets *S = malloc(sizeof(seedsets));
+    S->nb_sets = 0;
+    S->cd = malloc((s1+1)*sizeof(unsigned long));
+    S->seeds = malloc(s2*sizeof(unsigned long));
+    S->cd[0] = 0;
+    while (getline(&line, &length, file) != -1){
+        c = line;
+        while (1){
+            node = strtoul(c, &end, 10);
+            if (end == c)
+                break;
+            c = end;
+            if (node >= n){
+                printf("Seed %lu is not in the graph: ignored\n", node);
+                continue;
+            }
+            S->seeds[nb_seeds] = node;
+            if (++nb_seeds == s2){ // increase allocated RAM if needed
+                s2 += NSEEDS;
+                S->seeds = realloc(S->seeds, s2*sizeof(unsigned long));
+            }
+        }
+        if (nb_seeds == S->cd[S->nb_sets]) // empty seed set
+            continue;
+        S->cd[++(S->nb_sets)] = nb_seeds;
+        if (S->nb_sets == s1){ // increase allocated RAM if needed
+            s1 += NSEEDS;
+            S->cd = realloc(S->cd, (s1+1)*sizeof(unsigned long));
+        }
+    }
+    free(line);
+    fclose(file);
+    return S;
+}
+
+void free_seedsets(seedsets *S){
+    free(S->cd);
+    free(S->seeds);
+    free(S);
+}
+
+workspace* alloc_workspace(unsigned long n){
+    workspace *w = malloc(sizeof(workspace));
+    w->p = calloc(n, sizeof(double));
+    w->r = calloc(n, sizeof(double));
+    w->in_queue = calloc(n, sizeof(unsigned char));
+    w->touched = calloc(n, sizeof(unsigned char));
+    w->queue = malloc(n*sizeof(unsigned long));
+    w->list = malloc(n*sizeof(unsigned long));
+    w->nb_touched = 0;
+    return w;
+}
+
+void free_workspace(workspace *w){
+    free(w->p);
+    free(w->r);
+    free(w->in_queue);
+    free(w->touched);
+    free(w->queue);
+    free(w->list);
+    free(w);
+}
+
+// adding a node to the list of the touched nodes
+static inline void touch(workspace *w, unsigned long u){
+    if (!w->touched[u]){
+        w->touched[u] = 1;
+        w->list[w->nb_touched++] = u;
+    }
+}
+
+// resetting the touched nodes only
+void reset_workspace(workspace *w){
+    unsigned long i, u;
+    for (i=0; i<w->nb_touched; i++){
+        u = w->list[i];
+        w->p[u] = 0.;
+        w->r[u] = 0.;
+        w->touched[u] = 0;
+    }
+    w->nb_touched = 0;
+}
+
+// random number in [0,1) (xorshift64*)
+static inline double random_double(workspace *w){
+    w->state ^= w->state >> 12;
+    w->state ^= w->state << 25;
+    w->state ^= w->state >> 27;
+    return ((w->state * 0x2545F4914F6CDD1DULL) >> 11) * (1.0/9007199254740992.0);
+}
+
+// forward push from the seed set seeds[0..nb_seeds-1], returns the number of pushes
+// the residual of a dead end goes back to the seed set
+unsigned long forward_push(edgelist *g, unsigned long *seeds, unsigned long nb_seeds, workspace *w, unsigned long *nb_edges){
+    unsigned long i, u, v, degree, head = 0, tail = 0, size = 0, nb_pushes = 0;
+    double r, push;
+    for (i=0; i<nb_seeds; i++){
+        u = seeds[i];
+        touch(w, u);
+        w->r[u] += 1./nb_seeds;
+    }
+    for (i=0; i<nb_seeds; i++){
+        u = seeds[i];
+        degree = g->cd[u+1] - g->cd[u];
+        if (!w->in_queue[u] && w->r[u] >= EPSILON * (degree > 0 ? degree : 1)){
+            w->queue[tail] = u;
+            tail = (tail+1 == g->n) ? 0 : tail+1;
+            size++;
+            w->in_queue[u] = 1;
+        }
+    }
+    while (size > 0){
+        u = w->queue[head];
+        head = (head+1 == g->n) ? 0 : head+1;
+        size--;
+        w->in_queue[u] = 0;
+        r = w->r[u];
+        w->r[u] = 0.;
+        w->p[u] += ALPHA * r;
+        nb_pushes++;
+        degree = g->cd[u+1] - g->cd[u];
+        if (degree == 0){
+            // back to the seed set
+            push = (1-ALPHA) * r / nb_seeds;
+            for (i=0; i<nb_seeds; i++){
+                v = seeds[i];
+                w->r[v] += push;
+                if (!w->in_queue[v] && w->r[v] >= EPSILON * (g->cd[v+1] > g->cd[v] ? g->cd[v+1] - g->cd[v] : 1)){
+                    w->queue[tail] = v;
+                    tail = (tail+1 == g->n) ? 0 : tail+1;
+                    size++;
+                    w->in_queue[v] = 1;
+                }
+            }
+            continue;
+        }
+        push = (1-ALPHA) * r / degree;
+        for (i=g->cd[u]; i<g->cd[u+1]; i++){
+            v = g->adj[i];
+            touch(w, v);
+            w->r[v] += push;
+            if (!w->in_queue[v] && w->r[v] >= EPSILON * (g->cd[v+1] > g->cd[v] ? g->cd[v+1] - g->cd[v] : 1)){
+                w->queue[tail] = v;
+                tail = (tail+1 == g->n) ? 0 : tail+1;
+                size++;
+                w->in_queue[v] = 1;
+            }
+        }
+        *nb_edges += degree;
+    }
+    return nb_pushes;
+}
+
+// Monte Carlo: NB_WALKS random walks from a random seed, stopping with probability ALPHA at each step (going back to a random seed from the dead ends)
+// the personalized PageRank of a node is estimated by the fraction of the walks ending on it, returns the number of steps
+unsigned long monte_carlo(edgelist *g, unsigned long *seeds, unsigned long nb_seeds, workspace *w){
+    unsigned long i, u, degree, nb_steps = 0;
+    for (i=0; i<NB_WALKS; i++){
+        u = seeds[(unsigned long)(random_double(w) * nb_seeds)];
+        while (random_double(w) >= ALPHA){
+            degree = g->cd[u+1] - g->cd[u];
+            if (degree == 0)
+                u = seeds[(unsigned long)(random_double(w) * nb_seeds)];
+            else
+                u = g->adj[g->cd[u] + (unsigned long)(random_double(w) * degree)];
+            nb_steps++;
+        }
+        touch(w, u);
+        w->p[u] += 1./NB_WALKS;
+    }
+    return nb_steps;
+}
+
+// comparing 2 elements
+static int compare_scores(void const *e1, void const *e2){
+    page_rank const *element1 = e1;
+    page_rank const *element2 = e2;
+    if (element1->score - element2->score > 0)
+        return -1;
+    else if (element1->score - element2->score < 0)
+        return 1;
+    else
+        return 0;
+}
+
+int main(int argc, char** argv){
+    edgelist* g;
+    seedsets* S;
+    time_t t1,t2;
+    t1=time(NULL);
+    printf("Reading edgelist from file %s\n", argv[1]);
+    g=readedgelist(argv[1]);
+    printf("Number of nodes: %lu\n",g->n);
+    printf("Number of edges: %lu\n",g->e);
+    printf("Building the adjacency list\n");
+    mkadjlist(g);
+    printf("Reading seed sets from file %s\n", argv[2]);
+    S = readseeds(argv[2], g->n);
+    printf("Number of seed sets: %lu\n", S->nb_sets);
+    // initialisation
+    unsigned long k = (argc > 4) ? strtoul(argv[4], NULL, 10) : NB_RESULTS;
+    int push = (argc > 5 && strcmp(argv[5], "montecarlo") == 0) ? 0 : 1;
+    unsigned long nb_threads = omp_get_max_threads();
+    unsigned long i, j, nb_work = 0, nb_edges = 0, nb_touched = 0;
+    // k best nodes of each seed set (fewer if fewer nodes are touched)
+    page_rank *results = malloc(S->nb_sets*k*sizeof(page_rank));
+    unsigned long *nb_results = malloc(S->nb_sets*sizeof(unsigned long));
+    workspace **W = malloc(nb_threads*sizeof(workspace*));
+    for (i=0; i<nb_threads; i++){
+        W[i] = alloc_workspace(g->n);
+        W[i]->state = 0x9E3779B97F4A7C15ULL * (i+1);
+    }
+    printf("Computing personalized PageRank with %s: ", push ? "forward push" : "Monte Carlo");
+    fflush(stdout);
+    #pragma omp parallel for schedule(dynamic) reduction(+:nb_work,nb_edges,nb_touched)
+    for (i=0; i<S->nb_sets; i++){
+        workspace *w = W[omp_get_thread_num()];
+        unsigned long l, size;
+        page_rank *scores;
+        if (push)
+            nb_work += forward_push(g, S->seeds+S->cd[i], S->cd[i+1]-S->cd[i], w, &nb_edges);
+        else
+            nb_work += monte_carlo(g, S->seeds+S->cd[i], S->cd[i+1]-S->cd[i], w);
+        // sorting the touched nodes by score
+        scores = malloc(w->nb_touched*sizeof(page_rank));
+        size = 0;
+        for (l=0; l<w->nb_touched; l++){
+            if (w->p[w->list[l]] > 0.){
+                scores[size].node = w->list[l];
+                scores[size++].score = w->p[w->list[l]];
+            }
+        }
+        qsort(scores, size, sizeof(page_rank), compare_scores);
+        nb_results[i] = (size < k) ? size : k;
+        memcpy(results+i*k, scores, nb_results[i]*sizeof(page_rank));
+        free(scores);
+        nb_touched += w->nb_touched;
+        reset_workspace(w);
+    }
+    printf("done.\n");
+    if (push)
+        printf("Number of pushes: %lu (%lu edges)\n", nb_work, nb_edges);
+    else
+        printf("Number of random walk steps: %lu\n", nb_work);
+    printf("Average number of touched nodes per seed set: %0.1f\n", S->nb_sets > 0 ? (double)nb_touched/S->nb_sets : 0.);
+    // writing results in file
+    FILE *f = fopen(argv[3], "w");
+    fprintf(f, "Personalized PageRank results with alpha = %f:\n", ALPHA);
+    if (push)
+        fprintf(f, "(forward push with epsilon = %e)\n", EPSILON);
+    else
+        fprintf(f, "(Monte Carlo with %d random walks per seed set)\n", NB_WALKS);
+    for (i=0; i<S->nb_sets; i++){
+        fprintf(f, "\nSeed set %lu:", i);
+        for (j=S->cd[i]; j<S->cd[i+1]; j++){
+            fprintf(f, " %lu", S->seeds[j]);
+        }
+        fprintf(f, "\n");
+        for (j=0; j<nb_results[i]; j++){
+            fprintf(f, "%lu: Node %lu with score %0.10f\n", j+1, results[i*k+j].node, results[i*k+j].score);
+        }
+    }
+    fclose(f);
+    for (i=0; i<nb_threads; i++){
+        free_workspace(W[i]);
+    }
+    free(W);
+    free(results);
+    free(nb_results);
+    free_seedsets(S);
+    free_edgelist(g);
+    t2=time(NULL);
+    printf("- Overall time = %ldh%ldm%lds\n",(t2-t1)/3600,((t2-t1)%3600)/60,((t2-t1)%60));
+    return 0;
+}
@@ -0,0 +1,462 @@
+/*
+The program computes the strongly connected components (SCC) of a directed graph and its bow-tie structure around the largest SCC. The nodes without incoming or outgoing edges (trim-1) and the isolated pairs of nodes (trim-2) are removed first, the giant SCC is then found with parallel forward and backward reachability from a pivot node (FW-BW), and the remaining SCCs are found by parallel coloring.
+
+The program expects the following arguments:
+- edgelist.txt that should contain the graph: one edge on each line (two unsigned long (nodes' ID) separated by a space), the edge going from the first node to the second one;
+- results.txt for writing the results: the bow-tie breakdown, then the SCC ID (the ID of one of its nodes) and the bow-tie class of each node.
+
+To compile:
+"gcc scc.c -O3 -fopenmp -o scc".
+
+To execute:
+"./scc graphs/tuto_graph.txt results/tuto_scc.txt".
+*/
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h> // to estimate the runing time
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#define omp_get_thread_num() 0
+#define omp_get_num_threads() 1
+#endif
+
+#define NLINKS 100000000 // maximum number of edges for memory allocation, will increase if needed
+
+// flags of the nodes during the traversals
+#define ASSIGNED 1 // the SCC of the node is known
+#define FORWARD 2 // reached by the forward traversal
+#define BACKWARD 4 // reached by the backward traversal
+#define FROM_IN 8 // reached from the IN set (tendrils and tubes)
+#define TO_OUT 16 // reaching the OUT set (tendrils and tubes)
+
+typedef struct {
+    unsigned long s;
+    unsigned long t;
+} edge;
+
+// directed graph structure:
+typedef struct {
+    unsigned long n; // number of nodes
+    unsigned long e; // number of edges
+    edge *edges; // list of edges
+    unsigned long *cd_out; // cumulative out-degree cd_out[0]=0 length=n+1
+    unsigned long *adj_out; // concatenated lists of out-neighbors of all nodes
+    unsigned long *cd_in; // cumulative in-degree cd_in[0]=0 length=n+1
+    unsigned long *adj_in; // concatenated lists of in-neighbors of all nodes
+} digraph;
+
+// compute the maximum of three unsigned long
+inline unsigned long max3(unsigned long a,unsigned long b,unsigned long c){
+    a=(a>b) ? a : b;
+    return (a>c) ? a : c;
+}
+
+// reading the edgelist from file
+digraph* readedgelist(char* input){
+    unsigned long e1=NLINKS;
+    FILE *file=fopen(input,"r");
+    digraph *g=malloc(sizeof(digraph));
+    g->n=0;
+    g->e=0;
+    g->edges=malloc(e1*sizeof(edge));//allocate some RAM to store edges
+    while (fscanf(file,"%lu %lu", &(g->edges[g->e].s), &(g->edges[g->e].t))==2) {
+        g->n=max3(g->n,g->edges[g->e].s,g->edges[g->e].t);
+        if (++(g->e)==e1) {//increase allocated RAM if needed
+            e1+=NLINKS;
+            g->edges=realloc(g->edges,e1*sizeof(edge));
+        }
+    }
+    fclose(file);
+    g->n++;
+    g->edges=realloc(g->edges,g->e*sizeof(edge));
+    return g;
+}
+
+// building the out- and in-adjacency lists
+void mkdigraph(digraph* g){
+    unsigned long i,u,v;
+    unsigned long *d_out=calloc(g->n,sizeof(unsigned long));
+    unsigned long *d_in=calloc(g->n,sizeof(unsigned long));
+    for (i=0;i<g->e;i++) {
+        d_out[g->edges[i].s]++;
+        d_in[g->edges[i].t]++;
+    }
+    g->cd_out=malloc((g->n+1)*sizeof(unsigned long));
+    g->cd_in=malloc((g->n+1)*sizeof(unsigned long));
+    g->cd_out[0]=0;
+    g->cd_in[0]=0;
+    for (i=1;i<g->n+1;i++) {
+        g->cd_out[i]=g->cd_out[i-1]+d_out[i-1];
+        g->cd_in[i]=g->cd_in[i-1]+d_in[i-1];
+        d_out[i-1]=0;
+        d_in[i-1]=0;
+    }
+    g->adj_out=malloc(g->e*sizeof(unsigned long));
+    g->adj_in=malloc(g->e*sizeof(unsigned long));
+    for (i=0;i<g->e;i++) {
+        u=g->edges[i].s;
+        v=g->edges[i].t;
+        g->adj_out[ g->cd_out[u] + d_out[u]++ ]=v;
+        g->adj_in[ g->cd_in[v] + d_in[v]++ ]=u;
+    }
+    free(d_out);
+    free(d_in);
+}
+
+// freeing memory
+void free_digraph(digraph *g){
+    free(g->edges);
+    free(g->cd_out);
+    free(g->adj_out);
+    free(g->cd_in);
+    free(g->adj_in);
+    free(g);
+}
+
+// parallel level-synchronous BFS from the nodes fifo[0..nb_sources[ following the adjacency (cd, adj)
+// a node v is visited if none of the flags forbidden is set in mark[v], and is claimed by atomically setting the flag bit (included in forbidden)
+// returns the number of nodes in the FIFO (sources included)
+unsigned long reach(unsigned long *cd, unsigned long *adj, unsigned long *fifo, unsigned long nb_sources, unsigned char *mark, unsigned char forbidden, unsigned char bit){
+    // the FIFO stores the levels one after the other: the current level is fifo[b..e[ and the next one is written from e
+    unsigned long b = 0, e = nb_sources;
+    int nb_threads = omp_get_max_threads();
+    // offsets[t+1] is the number of nodes of the next level found by thread t, then its writing offset after the prefix sum
+    // (the team may be smaller than nb_threads, so the prefix sum only runs over the threads of the team)
+    unsigned long *offsets = calloc(nb_threads + 1, sizeof(unsigned long));
+    #pragma omp parallel num_threads(nb_threads)
+    {
+        int t = omp_get_thread_num(), nb_team = omp_get_num_threads(), k;
+        // thread-local buffer for the nodes of the next level
+        unsigned long size_buffer = 1024, nb_next, i, j, u, v;
+        unsigned long *buffer = malloc(size_buffer * sizeof(unsigned long));
+        while (b != e) { // current level not empty
+            nb_next = 0;
+            #pragma omp for schedule(dynamic, 64) nowait
+            for (i = b; i < e; i++){
+                u = fifo[i];
+                for (j = cd[u]; j < cd[u+1]; j++){
+                    v = adj[j];
+                    if ((mark[v] & forbidden) == 0 && (__sync_fetch_and_or(&mark[v], bit) & bit) == 0) {
+                        if (nb_next == size_buffer){ // increase the buffer if needed
+                            size_buffer *= 2;
+                            buffer = realloc(buffer, size_buffer * sizeof(unsigned long));
+                        }
+                        buffer[nb_next++] = v;
+                    }
+                }
+            }
+            offsets[t+1] = nb_next;
+            #pragma omp barrier
+            #pragma omp single
+            {
+                // prefix sum giving the position of each thread-local buffer in the next level
+                for (k = 1; k <= nb_team; k++){
+                    offsets[k] += offsets[k-1];
+                }
+            }
+            memcpy(fifo + e + offsets[t], buffer, nb_next * sizeof(unsigned long));
+            #pragma omp barrier
+            #pragma omp single
+            {
+                // the next level becomes the current level
+                b = e;
+                e += offsets[nb_team];
+            }
+        }
+        free(buffer);
+    }
+    free(offsets);
+    return e;
+}
+
+// returns the only unassigned neighbor of u in (cd, adj) other than u itself, or ULONG_MAX if there are zero or several of them
+unsigned long only_neighbor(unsigned long *cd, unsigned long *adj, unsigned char *mark, unsigned long u){
+    unsigned long i, v, found = ULONG_MAX;
+    for (i = cd[u]; i < cd[u+1]; i++){
+        v = adj[i];
+        if (v != u && !(mark[v] & ASSIGNED) && v != found){
+            if (found != ULONG_MAX)
+                return ULONG_MAX;
+            found = v;
+        }
+    }
+    return found;
+}
+
+// trim-1: assigning to their own SCC the nodes without unassigned in- or out-neighbors, until none is left
+unsigned long trim1(digraph *g, unsigned long *scc, unsigned char *mark){
+    unsigned long trimmed = 0, round;
+    do {
+        round = 0;
+        #pragma omp parallel for schedule(dynamic, 1024) reduction(+:round)
+        for (unsigned long u = 0; u < g->n; u++){
+            unsigned long i;
+            int has_in = 0, has_out = 0;
+            if (mark[u] & ASSIGNED)
+                continue;
+            for (i = g->cd_out[u]; i < g->cd_out[u+1] && !has_out; i++){
+                has_out = (g->adj_out[i] != u && !(mark[g->adj_out[i]] & ASSIGNED));
+            }
+            for (i = g->cd_in[u]; i < g->cd_in[u+1] && !has_in; i++){
+                has_in = (g->adj_in[i] != u && !(mark[g->adj_in[i]] & ASSIGNED));
+            }
+            if (!has_in || !has_out){
+                scc[u] = u;
+                mark[u] |= ASSIGNED;
+                round++;
+            }
+        }
+        trimmed += round;
+    } while (round > 0);
+    return trimmed;
+}
+
+// trim-2: assigning to their SCC the pairs of nodes u <-> v such that u and v have no other unassigned in-neighbors (or no other out-neighbors)
+unsigned long trim2(digraph *g, unsigned long *scc, unsigned char *mark){
+    unsigned long trimmed = 0;
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(+:trimmed)
+    for (unsigned long u = 0; u < g->n; u++){
+        unsigned long v;
+        if (mark[u] & ASSIGNED)
+            continue;
+        // the pair is handled by its smallest node
+        v = only_neighbor(g->cd_in, g->adj_in, mark, u);
+        if (v == ULONG_MAX || v < u || only_neighbor(g->cd_in, g->adj_in, mark, v) != u){
+            v = only_neighbor(g->cd_out, g->adj_out, mark, u);
+            if (v == ULONG_MAX || v < u || only_neighbor(g->cd_out, g->adj_out, mark, v) != u)
+                continue;
+        }
+        scc[u] = u;
+        scc[v] = u;
+        trimmed += 2;
+    }
+    // marking after the loop so that the tests above see a consistent state
+    #pragma omp parallel for
+    for (unsigned long u = 0; u < g->n; u++){
+        if (!(mark[u] & ASSIGNED) && scc[u] != ULONG_MAX)
+            mark[u] |= ASSIGNED;
+    }
+    return trimmed;
+}
+
+// FW-BW: assigning to the SCC of the pivot the unassigned nodes both reachable from and reaching the pivot
+unsigned long forward_backward(digraph *g, unsigned long pivot, unsigned long *scc, unsigned char *mark, unsigned long *fifo){
+    unsigned long u, size = 0;
+    fifo[0] = pivot;
+    mark[pivot] |= FORWARD;
+    reach(g->cd_out, g->adj_out, fifo, 1, mark, ASSIGNED | FORWARD, FORWARD);
+    fifo[0] = pivot;
+    mark[pivot] |= BACKWARD;
+    reach(g->cd_in, g->adj_in, fifo, 1, mark, ASSIGNED | BACKWARD, BACKWARD);
+    #pragma omp parallel for reduction(+:size)
+    for (u = 0; u < g->n; u++){
+        if ((mark[u] & (FORWARD | BACKWARD)) == (FORWARD | BACKWARD)){
+            scc[u] = pivot;
+            size++;
+        }
+        mark[u] &= ~(FORWARD | BACKWARD);
+        if (scc[u] == pivot)
+            mark[u] |= ASSIGNED;
+    }
+    return size;
+}
+
+// coloring: propagating the largest node ID along the edges, then each node keeping its color is the root of an SCC made of the nodes of its color reaching it
+unsigned long coloring(digraph *g, unsigned long *scc, unsigned char *mark, unsigned long *color){
+    unsigned long u, nb_rounds = 0, remaining;
+    int changed;
+    do {
+        nb_rounds++;
+        #pragma omp parallel for
+        for (u = 0; u < g->n; u++){
+            color[u] = u;
+        }
+        // pulling the largest color of the unassigned in-neighbors until a fixpoint
+        do {
+            changed = 0;
+            #pragma omp parallel for schedule(dynamic, 1024) reduction(|:changed)
+            for (u = 0; u < g->n; u++){
+                unsigned long i, v, c = color[u];
+                if (mark[u] & ASSIGNED)
+                    continue;
+                for (i = g->cd_in[u]; i < g->cd_in[u+1]; i++){
+                    v = g->adj_in[i];
+                    if (!(mark[v] & ASSIGNED) && color[v] > c)
+                        c = color[v];
+                }
+                if (c != color[u]){
+                    color[u] = c;
+                    changed = 1;
+                }
+            }
+        } while (changed);
+        // backward traversal from each root restricted to its color
+        remaining = 0;
+        #pragma omp parallel
+        {
+            unsigned long *fifo = malloc(16 * sizeof(unsigned long));
+            unsigned long size_fifo = 16, r, b, e, i, v, w;
+            #pragma omp for schedule(dynamic, 64)
+            for (r = 0; r < g->n; r++){
+                if ((mark[r] & ASSIGNED) || color[r] != r)
+                    continue;
+                b = 0;
+                e = 0;
+                fifo[e++] = r;
+                scc[r] = r;
+                while (b != e){
+                    v = fifo[b++];
+                    for (i = g->cd_in[v]; i < g->cd_in[v+1]; i++){
+                        w = g->adj_in[i];
+                        if (!(mark[w] & ASSIGNED) && color[w] == r && scc[w] != r){
+                            scc[w] = r;
+                            if (e == size_fifo){ // increase the FIFO if needed
+                                size_fifo *= 2;
+                                fifo = realloc(fifo, size_fifo * sizeof(unsigned long));
+                            }
+                            fifo[e++] = w;
+                        }
+                    }
+                }
+            }
+            free(fifo);
+        }
+        #pragma omp parallel for reduction(+:remaining)
+        for (u = 0; u < g->n; u++){
+            if (mark[u] & ASSIGNED)
+                continue;
+            if (scc[u] != ULONG_MAX)
+                mark[u] |= ASSIGNED;
+            else
+                remaining++;
+        }
+    } while (remaining > 0);
+    return nb_rounds;
+}
+
+int main(int argc, char** argv){
+    // using the digraph structure
+    digraph* g;
+    time_t t1,t2;
+    if (argc < 3){
+        printf("Usage: %s edgelist.txt results.txt\n", argv[0]);
+        return 1;
+    }
+    t1=time(NULL);
+    printf("Reading edgelist from file %s\n",argv[1]);
+    g=readedgelist(argv[1]);
+    printf("Number of nodes: %lu\n",g->n);
+    printf("Number of edges: %lu\n",g->e);
+    printf("Building the out- and in-adjacency lists\n");
+    mkdigraph(g);
+    // initialisation
+    unsigned long u, pivot = 0, best = 0, nb_scc = 0, giant = 0, nb_sources, nb_trim1, nb_trim2, size_pivot, nb_rounds;
+    unsigned long nb_class[6] = {0, 0, 0, 0, 0, 0};
+    const char *class_names[6] = {"SCC", "IN", "OUT", "TUBES", "TENDRILS", "DISCONNECTED"};
+    unsigned long *scc = malloc(g->n*sizeof(unsigned long));
+    unsigned long *sizes = calloc(g->n, sizeof(unsigned long));
+    unsigned long *fifo = malloc(g->n*sizeof(unsigned long));
+    unsigned char *mark = calloc(g->n, sizeof(unsigned char));
+    unsigned char *classes = malloc(g->n*sizeof(unsigned char));
+    for (u=0; u<g->n; u++){
+        scc[u] = ULONG_MAX;
+    }
+    // trimming
+    nb_trim1 = trim1(g, scc, mark);
+    nb_trim2 = trim2(g, scc, mark);
+    nb_trim1 += trim1(g, scc, mark);
+    printf("Trim-1: %lu nodes, trim-2: %lu nodes\n", nb_trim1, nb_trim2);
+    // FW-BW from the unassigned node with the largest product of degrees
+    for (u=0; u<g->n; u++){
+        if (!(mark[u] & ASSIGNED) && (g->cd_out[u+1]-g->cd_out[u])*(g->cd_in[u+1]-g->cd_in[u]) >= best){
+            best = (g->cd_out[u+1]-g->cd_out[u])*(g->cd_in[u+1]-g->cd_in[u]);
+            pivot = u;
+        }
+    }
+    if (best > 0){
+        size_pivot = forward_backward(g, pivot, scc, mark, fifo);
+        printf("FW-BW from node %lu: SCC of %lu nodes\n", pivot, size_pivot);
+    }
+    // coloring the remaining nodes
+    unsigned long *color = malloc(g->n*sizeof(unsigned long));
+    nb_rounds = coloring(g, scc, mark, color);
+    free(color);
+    printf("Coloring: %lu rounds\n", nb_rounds);
+    // sizes of the SCCs
+    for (u=0; u<g->n; u++){
+        if (sizes[scc[u]]++ == 0)
+            nb_scc++;
+        if (sizes[scc[u]] > sizes[giant])
+            giant = scc[u];
+    }
+    printf("Number of SCCs: %lu\n", nb_scc);
+    printf("Size of the largest SCC: %lu\n", sizes[giant]);
+    // bow-tie structure around the largest SCC: OUT is reachable from it, IN reaches it
+    memset(mark, 0, g->n*sizeof(unsigned char));
+    fifo[0] = giant;
+    mark[giant] = FORWARD;
+    reach(g->cd_out, g->adj_out, fifo, 1, mark, FORWARD, FORWARD);
+    fifo[0] = giant;
+    mark[giant] |= BACKWARD;
+    reach(g->cd_in, g->adj_in, fifo, 1, mark, BACKWARD, BACKWARD);
+    // nodes reachable from IN and nodes reaching OUT outside of the bow-tie core
+    nb_sources = 0;
+    for (u=0; u<g->n; u++){
+        if (mark[u] == BACKWARD)
+            fifo[nb_sources++] = u;
+    }
+    reach(g->cd_out, g->adj_out, fifo, nb_sources, mark, FORWARD | BACKWARD | FROM_IN, FROM_IN);
+    nb_sources = 0;
+    for (u=0; u<g->n; u++){
+        if (mark[u] == FORWARD)
+            fifo[nb_sources++] = u;
+    }
+    reach(g->cd_in, g->adj_in, fifo, nb_sources, mark, FORWARD | BACKWARD | TO_OUT, TO_OUT);
+    for (u=0; u<g->n; u++){
+        if ((mark[u] & (FORWARD | BACKWARD)) == (FORWARD | BACKWARD))
+            classes[u] = 0;
+        else if (mark[u] & BACKWARD)
+            classes[u] = 1;
+        else if (mark[u] & FORWARD)
+            classes[u] = 2;
+        else if ((mark[u] & (FROM_IN | TO_OUT)) == (FROM_IN | TO_OUT))
+            classes[u] = 3;
+        else if (mark[u] & (FROM_IN | TO_OUT))
+            classes[u] = 4;
+        else
+            classes[u] = 5;
+        nb_class[classes[u]]++;
+    }
+    printf("Bow-tie structure:\n");
+    for (u=0; u<6; u++){
+        printf("    %s: %lu nodes\n", class_names[u], nb_class[u]);
+    }
+    // writing results in file
+    FILE *f = fopen(argv[2], "w");
+    fprintf(f, "Number of SCCs: %lu\n", nb_scc);
+    fprintf(f, "Size of the largest SCC: %lu\n", sizes[giant]);
+    fprintf(f, "\nBow-tie structure:\n");
+    for (u=0; u<6; u++){
+        fprintf(f, "%s: %lu nodes\n", class_names[u], nb_class[u]);
+    }
+    fprintf(f, "\nFull SCC results (node, SCC ID, bow-tie class):\n");
+    for (u=0; u<g->n; u++){
+        fprintf(f, "%lu %lu %s\n", u, scc[u], class_names[classes[u]]);
+    }
+    fclose(f);
+    free(scc);
+    free(sizes);
+    free(fifo);
+    free(mark);
+    free(classes);
+    free_digraph(g);
+    t2=time(NULL);
+    printf("- Overall time = %ldh%ldm%lds\n",(t2-t1)/3600,((t2-t1)%3600)/60,((t2-t1)%60));
+    return 0;
+}